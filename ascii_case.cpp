@@ -0,0 +1,210 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "ascii_case.h"
+#include "simd.h"
+
+namespace nativa
+{
+	namespace
+	{
+		inline char lower(char c)
+		{
+			return ('A' <= c && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+		}
+
+		inline char upper(char c)
+		{
+			return ('a' <= c && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+		}
+
+		// Lower-cases eight chars packed in a word at once.
+		inline uint64_t lower_word(uint64_t word)
+		{
+			const uint64_t ones = 0x0101010101010101ull;
+			// the high bit of each byte is cleared so that the additions never carry over
+			const uint64_t heptets = word & (ones * 0x7F);
+			const uint64_t at_least_a = heptets + ones * (0x80 - 'A');
+			const uint64_t above_z = heptets + ones * (0x80 - 'Z' - 1);
+			const uint64_t is_upper = at_least_a & ~above_z & ~word & (ones * 0x80);
+			return word | (is_upper >> 2); // 0x80 >> 2 == 'a' - 'A'
+		}
+
+#ifdef NATIVA_SIMD_SSE2
+		// 0x20 in every byte holding a char in [first, first + 26), 0 elsewhere.
+		inline __m128i letter_bits(__m128i block, char first)
+		{
+			// move the range to the bottom of the signed bytes so that one compare does
+			const __m128i shifted = _mm_add_epi8(block, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+			const __m128i in_range = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+			return _mm_and_si128(in_range, _mm_set1_epi8('a' - 'A'));
+		}
+
+		inline __m128i lower_block(__m128i block)
+		{
+			return _mm_or_si128(block, letter_bits(block, 'A'));
+		}
+
+		inline __m128i upper_block(__m128i block)
+		{
+			return _mm_xor_si128(block, letter_bits(block, 'a'));
+		}
+
+		inline __m128i load(const char* src)
+		{
+			return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		}
+#endif
+
+		template <bool Upper>
+		void convert(const char* src, size_t size, char* dst)
+		{
+			size_t i = 0;
+#ifdef NATIVA_SIMD_SSE2
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i block = load(src + i);
+				block = Upper ? upper_block(block) : lower_block(block);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), block);
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				dst[i] = Upper ? upper(src[i]) : lower(src[i]);
+			}
+		}
+
+		template <bool Upper>
+		nativa::string converted(const string_view& str)
+		{
+			size_t size = str.size();
+			if (size == 0) return "";
+			char* buffer;
+			auto res = string_internals::alloc(size, buffer);
+			convert<Upper>(str.begin(), size, buffer);
+			return res;
+		}
+
+		// The first index where the two differ ignoring case, or size if they do not.
+		size_t mismatch_ignore_case(const char* left, const char* right, size_t size)
+		{
+			size_t i = 0;
+#ifdef NATIVA_SIMD_SSE2
+			for (; i + 16 <= size; i += 16)
+			{
+				const __m128i equal = _mm_cmpeq_epi8(lower_block(load(left + i)), lower_block(load(right + i)));
+				const uint32_t differ = ~static_cast<uint32_t>(_mm_movemask_epi8(equal)) & 0xFFFF;
+				if (differ != 0) return i + simd::lowest_bit(differ);
+			}
+#endif
+			for (; i < size; ++i)
+			{
+				if (lower(left[i]) != lower(right[i])) return i;
+			}
+			return size;
+		}
+	}
+
+	nativa::string to_lower_ascii(const string_view& str)
+	{
+		return converted<false>(str);
+	}
+
+	nativa::string to_upper_ascii(const string_view& str)
+	{
+		return converted<true>(str);
+	}
+
+	bool equals_ignore_case(const string_view& left, const string_view& right)
+	{
+		size_t size = left.size();
+		if (size != right.size()) return false;
+		return mismatch_ignore_case(left.begin(), right.begin(), size) == size;
+	}
+
+	int compare_ignore_case(const string_view& left, const string_view& right)
+	{
+		size_t l_size = left.size();
+		size_t r_size = right.size();
+		size_t common = l_size < r_size ? l_size : r_size;
+
+		size_t at = mismatch_ignore_case(left.begin(), right.begin(), common);
+		if (at != common)
+		{
+			return lower(left.begin()[at]) < lower(right.begin()[at]) ? -1 : 1;
+		}
+
+		if (l_size == r_size) return 0;
+		return l_size < r_size ? -1 : 1;
+	}
+
+	ptrdiff_t find_ignore_case(const string_view& str, const string_view& target, size_t from)
+	{
+		size_t size = str.size();
+		size_t t_size = target.size();
+		assert(from <= size);
+
+		if (t_size == 0) return from;
+		if (t_size > size - from) return -1;
+
+		const char* base = str.begin();
+		const char* t_base = target.begin();
+		const size_t last_start = size - t_size;
+		size_t i = from;
+
+#ifdef NATIVA_SIMD_SSE2
+		// filter candidates by their first and last chars, 16 positions a time
+		const __m128i first = _mm_set1_epi8(lower(t_base[0]));
+		const __m128i last = _mm_set1_epi8(lower(t_base[t_size - 1]));
+		for (; i + 16 <= last_start + 1; i += 16)
+		{
+			const __m128i head = _mm_cmpeq_epi8(lower_block(load(base + i)), first);
+			const __m128i tail = _mm_cmpeq_epi8(lower_block(load(base + i + t_size - 1)), last);
+			uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(head, tail)));
+			while (candidates != 0)
+			{
+				size_t at = i + simd::lowest_bit(candidates);
+				if (mismatch_ignore_case(base + at, t_base, t_size) == t_size) return at;
+				candidates &= candidates - 1;
+			}
+		}
+#endif
+		const char t_first = lower(t_base[0]);
+		for (; i <= last_start; ++i)
+		{
+			if (lower(base[i]) == t_first
+				&& mismatch_ignore_case(base + i, t_base, t_size) == t_size)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	size_t hash_ignore_case::operator()(const string_view& str) const
+	{
+		const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+		auto mix = [multiplier](uint64_t hash, uint64_t word)
+		{
+			hash = (hash ^ word) * multiplier;
+			return hash ^ (hash >> 29);
+		};
+
+		uint64_t hash = str.size() * multiplier;
+		const char* it = str.begin();
+		const char* end = str.end();
+		for (; end - it >= 8; it += 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, it, 8);
+			hash = mix(hash, lower_word(word));
+		}
+		if (it != end)
+		{
+			uint64_t word = 0;
+			std::memcpy(&word, it, end - it);
+			hash = mix(hash, lower_word(word));
+		}
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+}
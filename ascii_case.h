@@ -0,0 +1,57 @@
+#pragma once
+#ifndef NATIVA_ASCII_CASE
+#define NATIVA_ASCII_CASE
+
+#include <cstddef>
+#include "string.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Creates a copy of the string with 'A' to 'Z' turned into 'a' to 'z'.
+	/// Other chars, including non-ASCII ones, are copied as they are.
+	/// </summary>
+	/// <param name="str">The source string</param>
+	/// <returns>The lower-cased string, allocated once with the exact size</returns>
+	nativa::string to_lower_ascii(const string_view& str);
+
+	/// <summary>
+	/// Creates a copy of the string with 'a' to 'z' turned into 'A' to 'Z'.
+	/// Other chars, including non-ASCII ones, are copied as they are.
+	/// </summary>
+	/// <param name="str">The source string</param>
+	/// <returns>The upper-cased string, allocated once with the exact size</returns>
+	nativa::string to_upper_ascii(const string_view& str);
+
+	bool equals_ignore_case(const string_view& left, const string_view& right);
+
+	/// <summary>
+	/// Same as string_view::compare_to, but compares ASCII letters case-insensitively.
+	/// </summary>
+	int compare_ignore_case(const string_view& left, const string_view& right);
+
+	/// <summary>
+	/// Same as string_view::index_of, but compares ASCII letters case-insensitively.
+	/// </summary>
+	/// <returns>The index of the first match, or -1 if there is none</returns>
+	ptrdiff_t find_ignore_case(const string_view& str, const string_view& target, size_t from = 0);
+
+	/// <summary>
+	/// A hasher agreeing with equals_ignore_case, for unordered containers.
+	/// Note that it does not produce the same values as std::hash.
+	/// </summary>
+	struct hash_ignore_case
+	{
+		size_t operator()(const string_view& str) const;
+	};
+
+	struct equal_to_ignore_case
+	{
+		bool operator()(const string_view& left, const string_view& right) const
+		{
+			return equals_ignore_case(left, right);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocation_counting.h"
+
+namespace
+{
+	std::atomic<size_t> allocations{ 0 };
+
+	std::atomic<size_t> bytes{ 0 };
+}
+
+size_t allocation_count()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+size_t allocated_bytes()
+{
+	return bytes.load(std::memory_order_relaxed);
+}
+
+// every form is replaced, the array ones forwarding, so that each new pairs with its own delete
+void* operator new(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* res = std::malloc(size == 0 ? 1 : size)) return res;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	::operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	::operator delete(p);
+}
@@ -0,0 +1,15 @@
+#pragma once
+#ifndef NATIVA_BENCH_ALLOCATION_COUNTING
+#define NATIVA_BENCH_ALLOCATION_COUNTING
+
+#include <cstddef>
+
+// How many times the global operator new has been called, on any thread.
+// The replaced operators live in allocation_counting.cpp, out of reach of inlining,
+// so that no call site sees a delete freeing what a new it cannot match allocated.
+size_t allocation_count();
+
+// How many bytes the global operator new has been asked for, on any thread.
+size_t allocated_bytes();
+
+#endif
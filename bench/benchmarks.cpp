@@ -0,0 +1,947 @@
+// Benchmarks of the public operations against their std counterparts.
+// Usage: nativa_bench [--filter=text] [--min-time=seconds]
+// Prints CSV, one line per operation, implementation and input size:
+//   operation,implementation,size,ns_per_op,gb_per_s,allocs_per_op,bytes_per_op,cache_misses_per_op
+// gb_per_s is the input bytes processed per second, empty where it means nothing.
+// bytes_per_op is what operator new was asked for; cache_misses_per_op is counted on Linux
+// by perf_event_open for the benchmarking thread, and empty where the counter cannot be opened.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#if __has_include(<format>)
+#include <format>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#include "../string.h"
+#include "../string_view.h"
+#include "../string_builder.h"
+#include "../string_convert.h"
+#include "../concat.h"
+#include "../format.h"
+#include "../format_io.h"
+#include "../string_map.h"
+#include "../static_string_map.h"
+#include "../replacer.h"
+#include "../char_set.h"
+#include "../csv.h"
+#include "../binary_text.h"
+#include "../escape.h"
+#include "../parse_column.h"
+#include "../string_sort.h"
+#include "../compact_string.h"
+#include "../external_string.h"
+#include "allocation_counting.h"
+
+namespace
+{
+	double min_time = 0.05;
+
+	const char* filter = "";
+
+	template <typename T>
+	inline void keep(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	/// <summary>
+	/// The hardware cache misses of the calling thread, in user space.
+	/// </summary>
+	class cache_miss_counter
+	{
+	public:
+		cache_miss_counter()
+		{
+#if defined(__linux__)
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = PERF_COUNT_HW_CACHE_MISSES;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			m_fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			if (m_fd >= 0) ::ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+		}
+
+		~cache_miss_counter()
+		{
+#if defined(__linux__)
+			if (m_fd >= 0) ::close(m_fd);
+#endif
+		}
+
+		cache_miss_counter(const cache_miss_counter&) = delete;
+
+		cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+
+		/// <summary>
+		/// Whether the counter could be opened; perf_event_paranoid or a container may forbid it.
+		/// </summary>
+		bool available() const
+		{
+			return m_fd >= 0;
+		}
+
+		uint64_t read() const
+		{
+			uint64_t res = 0;
+#if defined(__linux__)
+			if (m_fd >= 0 && ::read(m_fd, &res, sizeof(res)) != sizeof(res)) res = 0;
+#endif
+			return res;
+		}
+
+	private:
+		int m_fd = -1;
+	};
+
+	/// <summary>
+	/// Runs the operation in batches growing until one lasts min_time, then reports that batch.
+	/// </summary>
+	/// <param name="bytes">Input bytes one run processes, 0 if throughput means nothing</param>
+	template <typename Operation>
+	void run(const char* operation, const char* implementation, size_t size, size_t bytes, const Operation& op)
+	{
+		if (std::strstr(operation, filter) == nullptr) return;
+
+		static const cache_miss_counter cache_misses;
+
+		op(); // warm up
+
+		for (size_t iterations = 1;; iterations *= 2)
+		{
+			size_t allocations_before = allocation_count();
+			size_t bytes_before = allocated_bytes();
+			uint64_t misses_before = cache_misses.read();
+			auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < iterations; ++i) op();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			uint64_t missed = cache_misses.read() - misses_before;
+			size_t allocated = allocation_count() - allocations_before;
+			size_t allocated_size = allocated_bytes() - bytes_before;
+
+			if (elapsed.count() < min_time) continue;
+
+			double seconds_per_op = elapsed.count() / iterations;
+			std::printf("%s,%s,%zu,%.2f,", operation, implementation, size, seconds_per_op * 1e9);
+			if (bytes != 0) std::printf("%.3f", bytes / seconds_per_op / 1e9);
+			std::printf(",%.2f,%.1f,", static_cast<double>(allocated) / iterations, static_cast<double>(allocated_size) / iterations);
+			if (cache_misses.available()) std::printf("%.2f", static_cast<double>(missed) / iterations);
+			std::printf("\n");
+			return;
+		}
+	}
+
+	std::string random_text(size_t size, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::string res(size, ' ');
+		for (auto& c : res) c = static_cast<char>('a' + rng() % 26);
+		return res;
+	}
+
+	nativa::string_view view_of(const std::string& str)
+	{
+		return nativa::string_view(str.data(), str.data() + str.size());
+	}
+
+	void searching(size_t size)
+	{
+		// the targets only occur at the very end
+		std::string text = random_text(size, 1);
+		text.back() = '#';
+		std::string needle = text.substr(size - 8);
+
+		auto nv = view_of(text);
+		auto n_needle = view_of(needle);
+		std::string_view sv(text);
+		std::string_view s_needle(needle);
+
+		run("find_char", "nativa", size, size, [&] { keep(nv.index_of('#')); });
+		run("find_char", "std", size, size, [&] { keep(sv.find('#')); });
+		run("find_substring", "nativa", size, size, [&] { keep(nv.index_of(n_needle)); });
+		run("find_substring", "std", size, size, [&] { keep(sv.find(s_needle)); });
+		run("contains", "nativa", size, size, [&] { keep(nv.contains(n_needle)); });
+		run("contains", "std", size, size, [&] { keep(sv.find(s_needle) != std::string_view::npos); });
+	}
+
+	void comparing(size_t size)
+	{
+		// equal contents in different buffers, so that everything is compared
+		std::string left = random_text(size, 2);
+		std::string right = left;
+
+		auto nl = view_of(left);
+		auto nr = view_of(right);
+		std::string_view sl(left);
+		std::string_view sr(right);
+		nativa::string ol = nl.clone();
+		nativa::string orr = nr.clone();
+
+		run("compare_to", "nativa", size, size, [&] { keep(nl.compare_to(nr)); });
+		run("compare_to", "std", size, size, [&] { keep(sl.compare(sr)); });
+		run("equals", "nativa", size, size, [&] { keep(nl == nr); });
+		run("equals", "nativa_string", size, size, [&] { keep(ol == orr); });
+		run("equals", "std", size, size, [&] { keep(sl == sr); });
+		run("hash", "nativa", size, size, [&] { keep(std::hash<nativa::string_view>()(nl)); });
+		run("hash", "nativa_string_cached", size, size, [&] { keep(ol.hash()); });
+		run("hash", "std", size, size, [&] { keep(std::hash<std::string_view>()(sl)); });
+	}
+
+	void building(size_t size)
+	{
+		std::string text = random_text(size, 3);
+		auto nv = view_of(text);
+		std::string_view sv(text);
+
+		const size_t third = size / 3;
+		auto na = nv.slice(0, third), nb = nv.slice(third, third), nc = nv.slice(2 * third, size - 2 * third);
+		auto sa = sv.substr(0, third), sb = sv.substr(third, third), sc = sv.substr(2 * third);
+
+		run("clone", "nativa", size, size, [&] { keep(nv.clone()); });
+		run("clone", "std", size, size, [&] { keep(std::string(sv)); });
+
+		run("concat", "nativa", size, size, [&] { keep(nativa::string::concat({ na, nb, nc })); });
+		run("concat", "nativa_plus", size, size, [&] { keep(nativa::string(na + nb + nc)); });
+		run("concat", "std", size, size, [&]
+		{
+			std::string res;
+			res.reserve(size);
+			res.append(sa).append(sb).append(sc);
+			keep(res);
+		});
+
+		// views, chars and numbers, as a key or a log line is put together
+		run("concat_mixed", "nativa_plus", size, size, [&] { keep(nativa::string(na + ':' + size + '/' + nb + "?v=" + 2.5)); });
+		run("concat_mixed", "std", size, size, [&] { keep(std::string(sa) + ':' + std::to_string(size) + '/' + std::string(sb) + "?v=" + std::to_string(2.5)); });
+
+		run("join", "nativa", size, size, [&] { keep(nativa::string::join(",", { na, nb, nc })); });
+		run("join", "std", size, size, [&]
+		{
+			std::string res;
+			res.reserve(size + 2);
+			res.append(sa).append(",").append(sb).append(",").append(sc);
+			keep(res);
+		});
+
+		// sixteen chars at a time, as a serializer would
+		run("builder_append", "nativa", size, size, [&]
+		{
+			nativa::string_builder builder;
+			for (size_t i = 0; i + 16 <= size; i += 16) builder.append(nv.slice(i, 16));
+			keep(builder.to_string());
+		});
+		run("builder_append", "std", size, size, [&]
+		{
+			std::string builder;
+			for (size_t i = 0; i + 16 <= size; i += 16) builder.append(sv.substr(i, 16));
+			keep(builder);
+		});
+		run("builder_append", "nativa_moved_out", size, size, [&]
+		{
+			nativa::string_builder builder;
+			for (size_t i = 0; i + 16 <= size; i += 16) builder.append(nv.slice(i, 16));
+			keep(std::move(builder).to_string());
+		});
+
+		// growing a string owned alone, in its own block, against a new string each time
+		run("string_append", "nativa_in_place", size, size, [&]
+		{
+			nativa::string res = nv.slice(0, 16).clone();
+			for (size_t i = 16; i + 16 <= size; i += 16) res = std::move(res).append(nv.slice(i, 16));
+			keep(res);
+		});
+		if (size <= 65536)
+		{
+			run("string_append", "nativa_concat", size, size, [&]
+			{
+				nativa::string res = nv.slice(0, 16).clone();
+				for (size_t i = 16; i + 16 <= size; i += 16) res = nativa::string::concat({ res, nv.slice(i, 16) });
+				keep(res);
+			});
+		}
+	}
+
+	void scanning(size_t size)
+	{
+		// a long run of padding around the text, then a run of identifier chars
+		std::string padded(size / 2, ' ');
+		for (size_t i = 0; i < padded.size(); i += 7) padded[i] = '\t';
+		padded += 'x';
+		padded.append(size / 2, ' ');
+		auto nv = view_of(padded);
+		std::string_view sv(padded);
+
+		run("trim", "nativa", size, size, [&] { keep(nv.trim().size()); });
+		run("trim", "std", size, size, [&]
+		{
+			size_t begin = sv.find_first_not_of(" \t\n\v\f\r");
+			size_t end = sv.find_last_not_of(" \t\n\v\f\r");
+			keep(begin == std::string_view::npos ? 0 : end + 1 - begin);
+		});
+
+		std::string identifier(size, 'a');
+		for (size_t i = 0; i < size; ++i) identifier[i] = "abcdefghijklmnopqrstuvwxyz_0123456789"[i % 37];
+		identifier.back() = '-';
+		auto ni = view_of(identifier);
+		std::string_view si(identifier);
+		const char identifier_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+		nativa::char_set identifier_set(identifier_chars);
+
+		run("span", "nativa", size, size, [&] { keep(ni.span(identifier_set)); });
+		run("span", "std", size, size, [&] { keep(si.find_first_not_of(identifier_chars)); });
+	}
+
+	void adopting(size_t size)
+	{
+		// a buffer handed over by a library, which gives it back through a deleter
+		const std::string text = random_text(size, 29);
+		run("ingest_buffer", "nativa_clone", size, size, [&]
+		{
+			keep(view_of(text).clone().size());
+		});
+		run("ingest_buffer", "nativa_adopt", size, size, [&]
+		{
+			keep(nativa::adopt_external(text.data(), text.size(), [](const char*, size_t) {}).size());
+		});
+		run("ingest_buffer", "nativa_adopt_c_str", size, size, [&]
+		{
+			keep(*nativa::adopt_external(text.data(), text.size(), [](const char*, size_t) {}).c_str());
+		});
+	}
+
+	void replacing(size_t size)
+	{
+		// a few matches per kilobyte, as in templating or escaping
+		std::string text = random_text(size, 6);
+		for (size_t i = 61; i + 4 <= size; i += 128) text.replace(i, 4, "{id}");
+		for (size_t i = 97; i < size; i += 256) text[i] = '<';
+		auto nv = view_of(text);
+		std::string_view sv(text);
+		nativa::string owned = nv.clone();
+
+		run("replace_all", "nativa", size, size, [&] { keep(nv.replace_all("{id}", "12345")); });
+		run("replace_all", "std", size, size, [&]
+		{
+			std::string res;
+			size_t begin = 0;
+			for (;;)
+			{
+				size_t found = sv.find("{id}", begin);
+				res.append(sv.substr(begin, found - begin));
+				if (found == std::string_view::npos) break;
+				res.append("12345");
+				begin = found + 4;
+			}
+			keep(res);
+		});
+		run("replace_all_no_match", "nativa", size, size, [&] { keep(owned.replace_all("{name}", "x")); });
+		run("replace_all_no_match", "std", size, size, [&]
+		{
+			std::string res;
+			size_t begin = 0;
+			for (;;)
+			{
+				size_t found = sv.find("{name}", begin);
+				res.append(sv.substr(begin, found - begin));
+				if (found == std::string_view::npos) break;
+				res.append("x");
+				begin = found + 6;
+			}
+			keep(res);
+		});
+
+		nativa::replacer escaper({ { "&", "&amp;" }, { "<", "&lt;" }, { ">", "&gt;" }, { "{id}", "12345" } });
+		run("replace_pairs", "nativa", size, size, [&] { keep(escaper.replace_all(nv)); });
+	}
+
+	void encoding_binary(size_t size)
+	{
+		std::string bytes(size, '\0');
+		std::mt19937 rng(9);
+		for (auto& byte : bytes) byte = static_cast<char>(rng());
+		auto nv = view_of(bytes);
+
+		// what one writes without a library: a table lookup per char into a std::string
+		const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		run("base64_encode", "nativa", size, size, [&] { keep(nativa::base64_encode(nv)); });
+		run("base64_encode", "std_loop", size, size, [&]
+		{
+			std::string res;
+			res.reserve((size + 2) / 3 * 4);
+			size_t i = 0;
+			for (; i + 3 <= size; i += 3)
+			{
+				const uint32_t group = static_cast<uint8_t>(bytes[i]) << 16 | static_cast<uint8_t>(bytes[i + 1]) << 8 | static_cast<uint8_t>(bytes[i + 2]);
+				res += chars[group >> 18];
+				res += chars[(group >> 12) & 63];
+				res += chars[(group >> 6) & 63];
+				res += chars[group & 63];
+			}
+			keep(res);
+		});
+
+		nativa::string encoded = nativa::base64_encode(nv);
+		run("base64_decode", "nativa", size, encoded.size(), [&]
+		{
+			nativa::string res;
+			keep(nativa::base64_decode(encoded, res));
+			keep(res);
+		});
+
+		run("hex_encode", "nativa", size, size, [&] { keep(nativa::hex_encode(nv)); });
+		run("hex_encode", "std_loop", size, size, [&]
+		{
+			std::string res;
+			res.reserve(size * 2);
+			for (char byte : bytes)
+			{
+				res += "0123456789abcdef"[static_cast<uint8_t>(byte) >> 4];
+				res += "0123456789abcdef"[byte & 15];
+			}
+			keep(res);
+		});
+
+		nativa::string hex = nativa::hex_encode(nv);
+		run("hex_decode", "nativa", size, hex.size(), [&]
+		{
+			nativa::string res;
+			keep(nativa::hex_decode(hex, res));
+			keep(res);
+		});
+	}
+
+	void escaping(size_t size)
+	{
+		// log lines: mostly clean, and with a quote, a tab or a newline every 64 chars
+		nativa::string clean = view_of(random_text(size, 10)).clone();
+		std::string dirty_text = random_text(size, 11);
+		const char specials[] = { '"', '\t', '\n', '\\' };
+		for (size_t i = 63; i < size; i += 64) dirty_text[i] = specials[i / 64 % 4];
+		nativa::string dirty = view_of(dirty_text).clone();
+
+		// what one writes without a library: a switch per char through string_builder::append(char)
+		auto char_loop = [](const nativa::string_view& text)
+		{
+			nativa::string_builder res;
+			for (char c : text)
+			{
+				switch (c)
+				{
+				case '"': res.append('\\').append('"'); break;
+				case '\\': res.append('\\').append('\\'); break;
+				case '\n': res.append('\\').append('n'); break;
+				case '\t': res.append('\\').append('t'); break;
+				default: res.append(c); break;
+				}
+			}
+			return res.to_string();
+		};
+
+		run("escape_json_clean", "nativa", size, size, [&] { keep(nativa::escape_json(clean)); });
+		run("escape_json_clean", "char_loop", size, size, [&] { keep(char_loop(clean)); });
+		run("escape_json_dirty", "nativa", size, size, [&] { keep(nativa::escape_json(dirty)); });
+		run("escape_json_dirty", "char_loop", size, size, [&] { keep(char_loop(dirty)); });
+
+		nativa::string escaped = nativa::escape_json(dirty);
+		run("unescape_json", "nativa", size, escaped.size(), [&]
+		{
+			nativa::string res;
+			keep(nativa::unescape_json(escaped, res));
+			keep(res);
+		});
+	}
+
+	void parsing_csv(size_t size)
+	{
+		// an export of 8 columns: numbers, words, and a quoted note now and then
+		std::mt19937 rng(12);
+		std::string text;
+		while (text.size() < size)
+		{
+			for (int column = 0; column < 8; ++column)
+			{
+				if (column != 0) text += ',';
+				const unsigned kind = rng() % 16;
+				if (kind == 0) text += "\"a note, with \"\"quotes\"\"\"";
+				else if (kind < 8) text += std::to_string(rng() % 100000);
+				else text += random_text(3 + rng() % 10, rng());
+			}
+			text += '\n';
+		}
+		text.resize(size);
+		auto nv = view_of(text);
+
+		run("parse_csv", "nativa", size, size, [&]
+		{
+			nativa::csv_parser parser(nv);
+			std::vector<nativa::string_view> fields;
+			size_t count = 0;
+			while (parser.next(fields)) count += fields.size();
+			keep(count);
+		});
+		// the two passes it replaces, which do not even handle the quotes
+		run("parse_csv", "split_lines_fields", size, size, [&]
+		{
+			std::vector<nativa::string_view> fields;
+			size_t count = 0;
+			for (const auto& line : nv.split_range('\n', static_cast<size_t>(-1), true))
+			{
+				fields.clear();
+				line.split(',', std::back_inserter(fields));
+				count += fields.size();
+			}
+			keep(count);
+		});
+	}
+
+	void splitting(size_t size)
+	{
+		std::string text = random_text(size, 4);
+		for (size_t i = 7; i < size; i += 8) text[i] = ',';
+		auto nv = view_of(text);
+		std::string_view sv(text);
+
+		run("split", "nativa", size, size, [&]
+		{
+			std::vector<nativa::string_view> res;
+			nv.split(',', std::back_inserter(res));
+			keep(res.size());
+		});
+		run("split", "nativa_range", size, size, [&]
+		{
+			size_t count = 0;
+			for (const auto& piece : nv.split_range(',')) count += piece.size();
+			keep(count);
+		});
+		run("split", "std", size, size, [&]
+		{
+			std::vector<std::string_view> res;
+			size_t begin = 0;
+			for (;;)
+			{
+				size_t end = sv.find(',', begin);
+				res.push_back(sv.substr(begin, end - begin));
+				if (end == std::string_view::npos) break;
+				begin = end + 1;
+			}
+			keep(res.size());
+		});
+
+		// owning copies of the pieces, one allocation each or one for all
+		run("split_clone", "nativa", size, size, [&]
+		{
+			std::vector<nativa::string> res;
+			nv.split_clone(',', std::back_inserter(res));
+			keep(res.size());
+		});
+		run("split_clone", "nativa_batch", size, size, [&]
+		{
+			std::vector<nativa::string> res;
+			nativa::string::clone_batch(nv.split_range(','), std::back_inserter(res));
+			keep(res.size());
+		});
+		run("split_clone", "std", size, size, [&]
+		{
+			std::vector<std::string> res;
+			size_t begin = 0;
+			for (;;)
+			{
+				size_t end = sv.find(',', begin);
+				res.emplace_back(sv.substr(begin, end - begin));
+				if (end == std::string_view::npos) break;
+				begin = end + 1;
+			}
+			keep(res.size());
+		});
+	}
+
+	void looking_up(size_t count)
+	{
+		// URL-ish keys, looked up by views into another buffer
+		std::vector<std::string> keys;
+		for (size_t i = 0; i < count; ++i)
+		{
+			keys.push_back("/api/v1/resource/" + std::to_string(i * 7919) + "/items");
+		}
+		std::vector<std::string> probes = keys;
+
+		nativa::string_map<size_t> n_map;
+		std::unordered_map<std::string, size_t> s_map;
+		for (size_t i = 0; i < count; ++i)
+		{
+			n_map.try_emplace(view_of(keys[i]), i);
+			s_map.emplace(keys[i], i);
+		}
+
+		size_t next = 0;
+		run("map_find", "nativa", count, 0, [&]
+		{
+			next = (next + 1) % count;
+			keep(n_map.find(view_of(probes[next]))->second);
+		});
+		run("map_find", "std", count, 0, [&]
+		{
+			next = (next + 1) % count;
+			keep(s_map.find(probes[next])->second);
+		});
+		run("map_insert", "nativa", count, 0, [&]
+		{
+			nativa::string_map<size_t> map;
+			for (size_t i = 0; i < count; ++i) map.try_emplace(view_of(keys[i]), i);
+			keep(map.size());
+		});
+		run("map_insert", "std", count, 0, [&]
+		{
+			std::unordered_map<std::string, size_t> map;
+			for (size_t i = 0; i < count; ++i) map.emplace(keys[i], i);
+			keep(map.size());
+		});
+	}
+
+	// the SQLite keywords, a typical fixed set for a parser
+	constexpr auto sql_keywords = nativa::make_static_string_map<int>({
+		{ "ABORT", 0 }, { "ACTION", 1 }, { "ADD", 2 }, { "AFTER", 3 }, { "ALL", 4 }, { "ALTER", 5 },
+		{ "ALWAYS", 6 }, { "ANALYZE", 7 }, { "AND", 8 }, { "AS", 9 }, { "ASC", 10 }, { "ATTACH", 11 },
+		{ "AUTOINCREMENT", 12 }, { "BEFORE", 13 }, { "BEGIN", 14 }, { "BETWEEN", 15 }, { "BY", 16 },
+		{ "CASCADE", 17 }, { "CASE", 18 }, { "CAST", 19 }, { "CHECK", 20 }, { "COLLATE", 21 }, { "COLUMN", 22 },
+		{ "COMMIT", 23 }, { "CONFLICT", 24 }, { "CONSTRAINT", 25 }, { "CREATE", 26 }, { "CROSS", 27 },
+		{ "CURRENT", 28 }, { "CURRENT_DATE", 29 }, { "CURRENT_TIME", 30 }, { "CURRENT_TIMESTAMP", 31 },
+		{ "DATABASE", 32 }, { "DEFAULT", 33 }, { "DEFERRABLE", 34 }, { "DEFERRED", 35 }, { "DELETE", 36 },
+		{ "DESC", 37 }, { "DETACH", 38 }, { "DISTINCT", 39 }, { "DO", 40 }, { "DROP", 41 }, { "EACH", 42 },
+		{ "ELSE", 43 }, { "END", 44 }, { "ESCAPE", 45 }, { "EXCEPT", 46 }, { "EXCLUDE", 47 }, { "EXCLUSIVE", 48 },
+		{ "EXISTS", 49 }, { "EXPLAIN", 50 }, { "FAIL", 51 }, { "FILTER", 52 }, { "FIRST", 53 },
+		{ "FOLLOWING", 54 }, { "FOR", 55 }, { "FOREIGN", 56 }, { "FROM", 57 }, { "FULL", 58 }, { "GENERATED", 59 },
+		{ "GLOB", 60 }, { "GROUP", 61 }, { "GROUPS", 62 }, { "HAVING", 63 }, { "IF", 64 }, { "IGNORE", 65 },
+		{ "IMMEDIATE", 66 }, { "IN", 67 }, { "INDEX", 68 }, { "INDEXED", 69 }, { "INITIALLY", 70 },
+		{ "INNER", 71 }, { "INSERT", 72 }, { "INSTEAD", 73 }, { "INTERSECT", 74 }, { "INTO", 75 }, { "IS", 76 },
+		{ "ISNULL", 77 }, { "JOIN", 78 }, { "KEY", 79 }, { "LAST", 80 }, { "LEFT", 81 }, { "LIKE", 82 },
+		{ "LIMIT", 83 }, { "MATCH", 84 }, { "MATERIALIZED", 85 }, { "NATURAL", 86 }, { "NO", 87 }, { "NOT", 88 },
+		{ "NOTHING", 89 }, { "NOTNULL", 90 }, { "NULL", 91 }, { "NULLS", 92 }, { "OF", 93 }, { "OFFSET", 94 },
+		{ "ON", 95 }, { "OR", 96 }, { "ORDER", 97 }, { "OTHERS", 98 }, { "OUTER", 99 }, { "OVER", 100 },
+		{ "PARTITION", 101 }, { "PLAN", 102 }, { "PRAGMA", 103 }, { "PRECEDING", 104 }, { "PRIMARY", 105 },
+		{ "QUERY", 106 }, { "RAISE", 107 }, { "RANGE", 108 }, { "RECURSIVE", 109 }, { "REFERENCES", 110 },
+		{ "REGEXP", 111 }, { "REINDEX", 112 }, { "RELEASE", 113 }, { "RENAME", 114 }, { "REPLACE", 115 },
+		{ "RESTRICT", 116 }, { "RETURNING", 117 }, { "RIGHT", 118 }, { "ROLLBACK", 119 }, { "ROW", 120 },
+		{ "ROWS", 121 }, { "SAVEPOINT", 122 }, { "SELECT", 123 }, { "SET", 124 }, { "TABLE", 125 },
+		{ "TEMP", 126 }, { "TEMPORARY", 127 }, { "THEN", 128 }, { "TIES", 129 }, { "TO", 130 },
+		{ "TRANSACTION", 131 }, { "TRIGGER", 132 }, { "UNBOUNDED", 133 }, { "UNION", 134 }, { "UNIQUE", 135 },
+		{ "UPDATE", 136 }, { "USING", 137 }, { "VACUUM", 138 }, { "VALUES", 139 }, { "VIEW", 140 },
+		{ "VIRTUAL", 141 }, { "WHEN", 142 }, { "WHERE", 143 }, { "WINDOW", 144 }, { "WITH", 145 },
+		{ "WITHOUT", 146 }
+	});
+
+	void looking_up_keywords()
+	{
+		std::unordered_map<std::string_view, int> s_map;
+		for (const auto& keyword : sql_keywords)
+		{
+			s_map.emplace(std::string_view(keyword.first.begin(), keyword.first.size()), keyword.second);
+		}
+
+		// mostly keywords, some identifiers, copied so that no pointer compares equal
+		std::vector<std::string> probes;
+		for (const auto& keyword : sql_keywords) probes.emplace_back(keyword.first.begin(), keyword.first.end());
+		for (const char* identifier : { "users", "orders", "id", "name", "created_at", "total", "SELECTED", "FROMS" })
+		{
+			probes.emplace_back(identifier);
+		}
+		std::shuffle(probes.begin(), probes.end(), std::mt19937(7));
+
+		const size_t count = sql_keywords.size();
+		size_t next = 0;
+		run("keyword_find", "nativa_static", count, 0, [&]
+		{
+			if (++next == probes.size()) next = 0;
+			keep(sql_keywords.value_or(view_of(probes[next]), -1));
+		});
+		run("keyword_find", "std", count, 0, [&]
+		{
+			if (++next == probes.size()) next = 0;
+			auto found = s_map.find(probes[next]);
+			keep(found == s_map.end() ? -1 : found->second);
+		});
+	}
+
+	void sorting(const char* dataset, const std::vector<std::string>& texts)
+	{
+		std::vector<nativa::string_view> views;
+		for (const auto& text : texts) views.push_back(view_of(text));
+		const size_t count = views.size();
+
+		// every run sorts a fresh copy, the copying being the same for all
+		auto sorted_by = [&](const char* implementation, auto&& sort)
+		{
+			std::string operation = std::string("sort_") + dataset;
+			run(operation.c_str(), implementation, count, 0, [&]
+			{
+				auto copy = views;
+				sort(copy.begin(), copy.end());
+				keep(copy.front());
+			});
+		};
+
+		using iterator = std::vector<nativa::string_view>::iterator;
+		sorted_by("std_sort", [](iterator first, iterator last) { std::sort(first, last); });
+		sorted_by("std_stable_sort", [](iterator first, iterator last) { std::stable_sort(first, last); });
+		sorted_by("nativa", [](iterator first, iterator last) { nativa::sort_strings(first, last); });
+		sorted_by("nativa_stable", [](iterator first, iterator last) { nativa::stable_sort_strings(first, last); });
+		sorted_by("nativa_parallel", [](iterator first, iterator last) { nativa::parallel_sort_strings(first, last); });
+	}
+
+	void sorting(size_t count)
+	{
+		std::mt19937 rng(5);
+
+		// long shared prefixes, then a few distinguishing parts
+		const char* hosts[] = { "https://www.example.com", "https://api.example.com", "https://cdn.example.org" };
+		const char* paths[] = { "/api/v1/users/", "/api/v1/orders/", "/static/images/", "/api/v2/users/" };
+		std::vector<std::string> urls;
+		for (size_t i = 0; i < count; ++i)
+		{
+			urls.push_back(std::string(hosts[rng() % 3]) + paths[rng() % 4] + std::to_string(rng() % 1000000) + "?page=" + std::to_string(rng() % 100));
+		}
+		sorting("urls", urls);
+
+		// timestamp first, so that most keys share their first dozen chars
+		const char* levels[] = { "INFO", "WARN", "ERROR", "DEBUG" };
+		std::vector<std::string> log_keys;
+		for (size_t i = 0; i < count; ++i)
+		{
+			char key[96];
+			std::snprintf(key, sizeof(key), "2024-05-%02u %02u:%02u:%02u.%06u %s service-%u",
+				static_cast<unsigned>(1 + rng() % 3), static_cast<unsigned>(rng() % 24), static_cast<unsigned>(rng() % 60),
+				static_cast<unsigned>(rng() % 60), static_cast<unsigned>(rng() % 1000000), levels[rng() % 4], static_cast<unsigned>(rng() % 50));
+			log_keys.push_back(key);
+		}
+		sorting("log_keys", log_keys);
+	}
+
+	template <typename handle>
+	void holding(const char* implementation, const std::vector<nativa::string>& strings)
+	{
+		const size_t count = strings.size();
+		std::vector<handle> handles(strings.begin(), strings.end());
+		std::unordered_set<handle> set(handles.begin(), handles.end());
+		// the probes are other blocks, so that no handle compares equal by its pointer
+		std::vector<handle> probes;
+		for (const auto& str : strings) probes.push_back(handle(str.view().clone()));
+
+		// the memory a table of them takes: the handles, and the blocks of clones made from views,
+		// so that bytes_per_op divided by the count is the cost of holding one string
+		run("handles_build", implementation, count, 0, [&]
+		{
+			std::vector<handle> built;
+			built.reserve(count);
+			for (const auto& str : strings) built.emplace_back(handle(str.view().clone()));
+			keep(built.back().size());
+		});
+		run("handles_scan", implementation, count, 0, [&]
+		{
+			size_t total = 0;
+			for (const auto& str : handles) total += str.size() + *str.begin();
+			keep(total);
+		});
+		run("handles_sort", implementation, count, 0, [&]
+		{
+			auto copy = handles;
+			std::sort(copy.begin(), copy.end());
+			keep(copy.front().size());
+		});
+		size_t next = 0;
+		run("handles_set_find", implementation, count, 0, [&]
+		{
+			if (++next == count) next = 0;
+			keep(set.find(probes[next]) != set.end());
+		});
+	}
+
+	void holding(size_t count)
+	{
+		// many small runtime strings allocated in a shuffled order, as a long-lived table would end up
+		std::vector<std::string> texts;
+		for (size_t i = 0; i < count; ++i) texts.push_back("user:" + std::to_string(i * 7919) + ":name");
+		std::shuffle(texts.begin(), texts.end(), std::mt19937(11));
+		std::vector<nativa::string> strings;
+		for (const auto& text : texts) strings.push_back(view_of(text).clone());
+
+		holding<nativa::string>("nativa", strings);
+		holding<nativa::compact_string>("nativa_compact", strings);
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	void writing(size_t size)
+	{
+		// a response head and body, sent to /dev/null so that only the copying differs
+		int fd = ::open("/dev/null", O_WRONLY);
+		if (fd < 0) return;
+
+		std::string body = random_text(size, 8);
+		auto nv = view_of(body);
+		const nativa::string_view head = "HTTP/1.1 200 OK\r\nContent-Length: {0}\r\n\r\n{1}";
+
+		run("write_formatted", "nativa_concat", size, size, [&]
+		{
+			nativa::string message = nativa::format(head, size, nv);
+			keep(::write(fd, message.begin(), message.size()));
+		});
+		run("write_formatted", "nativa_writev", size, size, [&] { nativa::write_formatted(fd, head, size, nv); });
+
+		::close(fd);
+	}
+#endif
+
+	void parsing_columns(size_t size)
+	{
+		std::mt19937 rng(13);
+		std::string integers;
+		while (integers.size() < size) integers += std::to_string(static_cast<int64_t>(rng()) - (int64_t(1) << 31)) + '\n';
+		std::string floats;
+		char buffer[32];
+		while (floats.size() < size)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%.3f\n", static_cast<double>(rng()) / 1000);
+			floats += buffer;
+		}
+		auto ni = view_of(integers);
+		auto nf = view_of(floats);
+		const size_t count = nativa::column_size(ni, '\n');
+		std::vector<int64_t> int_out(count);
+		std::vector<double> float_out(nativa::column_size(nf, '\n'));
+
+		run("parse_int_column", "nativa", size, integers.size(), [&]
+		{
+			keep(nativa::parse_column(ni, '\n', int_out.data(), int_out.size()).count);
+		});
+		// what it replaces: a split, then a parse per field
+		run("parse_int_column", "split_parse", size, integers.size(), [&]
+		{
+			size_t i = 0;
+			for (const auto& field : ni.split_range('\n', static_cast<size_t>(-1), true))
+			{
+				int_out[i++] = nativa::parse_signed_integral<int64_t>(field);
+			}
+			keep(i);
+		});
+		run("parse_int_column", "std_from_chars", size, integers.size(), [&]
+		{
+			const char* at = integers.data();
+			const char* end = at + integers.size();
+			size_t i = 0;
+			while (at != end)
+			{
+				at = std::from_chars(at, end, int_out[i++]).ptr + 1;
+			}
+			keep(i);
+		});
+
+		run("parse_float_column", "nativa", size, floats.size(), [&]
+		{
+			keep(nativa::parse_column(nf, '\n', float_out.data(), float_out.size()).count);
+		});
+		run("parse_float_column", "std_from_chars", size, floats.size(), [&]
+		{
+			const char* at = floats.data();
+			const char* end = at + floats.size();
+			size_t i = 0;
+			while (at != end)
+			{
+				at = std::from_chars(at, end, float_out[i++]).ptr + 1;
+			}
+			keep(i);
+		});
+	}
+
+	void converting()
+	{
+		int i = 0;
+		run("to_string_int", "nativa", 0, 0, [&] { keep(nativa::to_string(++i * 7919)); });
+		run("to_string_int", "std", 0, 0, [&] { keep(std::to_string(++i * 7919)); });
+
+		// the counters and codes of a metrics emitter, mostly small
+		unsigned small = 0;
+		run("to_string_small_int", "nativa", 0, 0, [&] { keep(nativa::to_string(++small % 10000)); });
+		run("to_string_small_int", "std", 0, 0, [&] { keep(std::to_string(++small % 10000)); });
+		run("format_small_int", "nativa", 0, 0, [&] { keep(nativa::format("status={0}", ++small % 600)); });
+
+		double d = 0;
+		run("to_string_double", "nativa", 0, 0, [&] { keep(nativa::to_string(d += 1.25)); });
+		run("to_string_double", "std", 0, 0, [&] { keep(std::to_string(d += 1.25)); });
+
+		const char* word = "benchmark";
+		run("format", "nativa", 0, 0, [&] { keep(nativa::format("{0}: {1} = {2}", ++i, word, 0.5)); });
+#if defined(__cpp_lib_format)
+		run("format", "std", 0, 0, [&] { keep(std::format("{}: {} = {}", ++i, word, 0.5)); });
+#else
+		run("format", "snprintf", 0, 0, [&]
+		{
+			char buffer[64];
+			std::snprintf(buffer, sizeof(buffer), "%d: %s = %g", ++i, word, 0.5);
+			keep(std::string(buffer));
+		});
+#endif
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strncmp(argv[i], "--filter=", 9) == 0) filter = argv[i] + 9;
+		else if (std::strncmp(argv[i], "--min-time=", 11) == 0) min_time = std::atof(argv[i] + 11);
+	}
+
+	std::printf("operation,implementation,size,ns_per_op,gb_per_s,allocs_per_op,bytes_per_op,cache_misses_per_op\n");
+
+	const size_t sizes[] = { 16, 256, 4096, 65536, 1 << 20 };
+	for (size_t size : sizes)
+	{
+		searching(size);
+		comparing(size);
+		building(size);
+		adopting(size);
+		replacing(size);
+		scanning(size);
+		encoding_binary(size);
+		escaping(size);
+		parsing_csv(size);
+		parsing_columns(size);
+		splitting(size);
+#if defined(__unix__) || defined(__APPLE__)
+		writing(size);
+#endif
+	}
+	for (size_t count : { 100, 10000, 1000000 })
+	{
+		looking_up(count);
+		sorting(count);
+		holding(count);
+	}
+	looking_up_keywords();
+	converting();
+}
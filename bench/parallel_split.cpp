@@ -0,0 +1,59 @@
+// Scaling benchmark of nativa::parallel_split.
+// Usage: parallel_split [megabytes = 1024] [max threads = hardware threads]
+// Prints one line per thread count: threads, seconds, GB/s and the speedup over one thread.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../parallel_split.h"
+
+int main(int argc, char** argv)
+{
+	const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+	size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+	if (max_threads == 0) max_threads = 1;
+
+	// log-like records of varying length
+	std::vector<char> text(megabytes << 20);
+	std::mt19937_64 rng(42);
+	size_t next_delim = 0;
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		if (i == next_delim)
+		{
+			text[i] = '\n';
+			next_delim = i + 1 + rng() % 160;
+		}
+		else
+		{
+			text[i] = static_cast<char>('a' + rng() % 26);
+		}
+	}
+	const nativa::string_view input(text.data(), text.data() + text.size());
+
+	std::vector<size_t> thread_counts;
+	for (size_t threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+	thread_counts.push_back(max_threads);
+
+	std::printf("threads,seconds,gb_per_s,speedup,slices\n");
+	double single = 0;
+	for (size_t threads : thread_counts)
+	{
+		double best = 1e30;
+		size_t slices = 0;
+		for (int round = 0; round < 3; ++round)
+		{
+			auto start = std::chrono::steady_clock::now();
+			auto res = nativa::parallel_split(input, '\n', threads);
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() < best) best = elapsed.count();
+			slices = res.size();
+		}
+		if (threads == 1) single = best;
+		std::printf("%zu,%.4f,%.3f,%.2f,%zu\n",
+			threads, best, text.size() / best / 1e9, single / best, slices);
+	}
+}
@@ -0,0 +1,397 @@
+#include <cstdint>
+#include "binary_text.h"
+#include "simd.h"
+
+namespace nativa
+{
+	namespace
+	{
+		const char standard_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		const char url_safe_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+		const char lower_digits[] = "0123456789abcdef";
+		const char upper_digits[] = "0123456789ABCDEF";
+
+		/// <summary>
+		/// The value of every char, -1 for those not in the alphabet.
+		/// </summary>
+		struct decode_table
+		{
+			int8_t values[256];
+
+			constexpr decode_table(const char* chars, size_t count)
+				: values{}
+			{
+				for (auto& value : values) value = -1;
+				for (size_t i = 0; i < count; ++i)
+				{
+					values[static_cast<uint8_t>(chars[i])] = static_cast<int8_t>(i);
+				}
+			}
+
+			int8_t operator[](char c) const
+			{
+				return values[static_cast<uint8_t>(c)];
+			}
+		};
+
+		constexpr decode_table standard_values(standard_chars, 64);
+		constexpr decode_table url_safe_values(url_safe_chars, 64);
+
+		// upper case digits are added over the lower case ones
+		struct hex_table : decode_table
+		{
+			constexpr hex_table()
+				: decode_table(lower_digits, 16)
+			{
+				for (size_t i = 10; i < 16; ++i)
+				{
+					values[static_cast<uint8_t>(upper_digits[i])] = static_cast<int8_t>(i);
+				}
+			}
+		};
+
+		constexpr hex_table hex_values;
+
+		/// <summary>
+		/// How many chars of the text are not padding, and where the padding is wrong.
+		/// </summary>
+		/// <returns>-1 if the padding is fine, otherwise the index of the first char in error</returns>
+		ptrdiff_t base64_body(const string_view& text, size_t& body)
+		{
+			const size_t size = text.size();
+			size_t padding = 0;
+			while (padding < 2 && padding < size && text.begin()[size - 1 - padding] == '=') ++padding;
+			body = size - padding;
+
+			// padding completes the last group, which then can only be 2 or 3 chars
+			if (padding != 0 && size % 4 != 0) return static_cast<ptrdiff_t>(body);
+			// a single char cannot hold a byte
+			if (body % 4 == 1) return static_cast<ptrdiff_t>(body - 1);
+			return -1;
+		}
+
+#ifdef NATIVA_SIMD_AVX2
+		inline __m256i in_range(__m256i chars, char low, char high)
+		{
+			return _mm256_and_si256(
+				_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(static_cast<char>(low - 1))),
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), chars));
+		}
+
+		inline __m256i equal_to(__m256i chars, char c)
+		{
+			return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(c));
+		}
+
+		/// <summary>
+		/// Turns 32 chars into their values by the ranges they fall in.
+		/// </summary>
+		/// <returns>The mask of the valid chars</returns>
+		inline uint32_t base64_values(__m256i chars, char c62, char c63, __m256i& values)
+		{
+			const __m256i upper = in_range(chars, 'A', 'Z');
+			const __m256i lower = in_range(chars, 'a', 'z');
+			const __m256i digit = in_range(chars, '0', '9');
+			const __m256i is62 = equal_to(chars, c62);
+			const __m256i is63 = equal_to(chars, c63);
+
+			__m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(is62, _mm256_set1_epi8(static_cast<char>(62 - c62))));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(is63, _mm256_set1_epi8(static_cast<char>(63 - c63))));
+			values = _mm256_add_epi8(chars, shift);
+
+			const __m256i valid = _mm256_or_si256(
+				_mm256_or_si256(upper, lower),
+				_mm256_or_si256(digit, _mm256_or_si256(is62, is63)));
+			return static_cast<uint32_t>(_mm256_movemask_epi8(valid));
+		}
+
+		inline uint32_t hex_values_of(__m256i chars, __m256i& values)
+		{
+			const __m256i digit = in_range(chars, '0', '9');
+			const __m256i lower = in_range(chars, 'a', 'f');
+			const __m256i upper = in_range(chars, 'A', 'F');
+
+			__m256i shift = _mm256_and_si256(digit, _mm256_set1_epi8(-'0'));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(10 - 'a')));
+			shift = _mm256_or_si256(shift, _mm256_and_si256(upper, _mm256_set1_epi8(10 - 'A')));
+			values = _mm256_add_epi8(chars, shift);
+
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(digit, _mm256_or_si256(lower, upper))));
+		}
+#endif
+	}
+
+	size_t base64_encoded_size(size_t bytes, base64_alphabet alphabet)
+	{
+		if (alphabet == base64_alphabet::standard) return (bytes + 2) / 3 * 4;
+		return bytes / 3 * 4 + (bytes % 3 == 0 ? 0 : bytes % 3 + 1);
+	}
+
+	size_t base64_decoded_size(const string_view& text)
+	{
+		size_t body;
+		base64_body(text, body);
+		const size_t tail = body % 4;
+		return body / 4 * 3 + (tail == 0 ? 0 : tail - 1);
+	}
+
+	void base64_encode(const string_view& bytes, char* out, base64_alphabet alphabet)
+	{
+		const bool standard = alphabet == base64_alphabet::standard;
+		const char* const chars = standard ? standard_chars : url_safe_chars;
+
+		const uint8_t* it = reinterpret_cast<const uint8_t*>(bytes.begin());
+		const uint8_t* const end = reinterpret_cast<const uint8_t*>(bytes.end());
+
+#ifdef NATIVA_SIMD_AVX2
+		// 24 bytes into 32 chars, each lane taking 12 bytes; the loads read 4 bytes past them
+		const __m256i spread = _mm256_setr_epi8(
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const char c62 = chars[62], c63 = chars[63];
+		const __m256i offsets = _mm256_setr_epi8(
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, static_cast<char>(c62 - 62), static_cast<char>(c63 - 63), 'A', 0, 0,
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, static_cast<char>(c62 - 62), static_cast<char>(c63 - 63), 'A', 0, 0);
+		for (; end - it >= 28; it += 24, out += 32)
+		{
+			const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 12));
+			const __m256i input = _mm256_shuffle_epi8(
+				_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), spread);
+
+			// each 3 bytes b0 b1 b2 now read b1 b0 b2 b1, from which the 4 sextets
+			// are moved into their own bytes by multiplications
+			const __m256i first_third = _mm256_mulhi_epu16(
+				_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+			const __m256i second_fourth = _mm256_mullo_epi16(
+				_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+			const __m256i indices = _mm256_or_si256(first_third, second_fourth);
+
+			// 0 for a-z, 1 to 10 for the digits, 11 and 12 for the last two, 13 for A-Z
+			__m256i ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			ranges = _mm256_or_si256(ranges, _mm256_and_si256(
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+			const __m256i encoded = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, ranges));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), encoded);
+		}
+#endif
+
+		for (; end - it >= 3; it += 3, out += 4)
+		{
+			const uint32_t group = static_cast<uint32_t>(it[0]) << 16 | static_cast<uint32_t>(it[1]) << 8 | it[2];
+			out[0] = chars[group >> 18];
+			out[1] = chars[(group >> 12) & 63];
+			out[2] = chars[(group >> 6) & 63];
+			out[3] = chars[group & 63];
+		}
+
+		if (it == end) return;
+		const bool two = end - it == 2;
+		const uint32_t group = static_cast<uint32_t>(it[0]) << 16 | (two ? static_cast<uint32_t>(it[1]) << 8 : 0);
+		*out++ = chars[group >> 18];
+		*out++ = chars[(group >> 12) & 63];
+		if (two) *out++ = chars[(group >> 6) & 63];
+		if (standard)
+		{
+			if (!two) *out++ = '=';
+			*out++ = '=';
+		}
+	}
+
+	nativa::string base64_encode(const string_view& bytes, base64_alphabet alphabet)
+	{
+		const size_t size = base64_encoded_size(bytes.size(), alphabet);
+		if (size == 0) return string("");
+
+		char* mutable_raw;
+		auto res = string_internals::alloc(size, mutable_raw);
+		base64_encode(bytes, mutable_raw, alphabet);
+		return std::move(res);
+	}
+
+	ptrdiff_t base64_decode(const string_view& text, char* out, base64_alphabet alphabet)
+	{
+		size_t body;
+		const ptrdiff_t padding_error = base64_body(text, body);
+
+		const bool standard = alphabet == base64_alphabet::standard;
+		const decode_table& values = standard ? standard_values : url_safe_values;
+
+		const char* const begin = text.begin();
+		const char* it = begin;
+		const char* const end = begin + body;
+
+#ifdef NATIVA_SIMD_AVX2
+		const char* const chars = standard ? standard_chars : url_safe_chars;
+		for (; end - it >= 32; it += 32, out += 24)
+		{
+			__m256i sextets;
+			const uint32_t valid = base64_values(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), chars[62], chars[63], sextets);
+			if (valid != 0xFFFFFFFFu) return (it - begin) + simd::lowest_bit(~valid);
+
+			// a b c d into ab and cd, then into the 24 bits of abcd, little endian
+			const __m256i pairs = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+			const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+			const __m256i packed = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			const __m256i bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(bytes));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_extracti128_si256(bytes, 1));
+		}
+#endif
+
+		for (; end - it >= 4; it += 4, out += 3)
+		{
+			const int8_t a = values[it[0]], b = values[it[1]], c = values[it[2]], d = values[it[3]];
+			if ((a | b | c | d) < 0)
+			{
+				for (ptrdiff_t i = 0;; ++i)
+				{
+					if (values[it[i]] < 0) return (it - begin) + i;
+				}
+			}
+			const uint32_t group = static_cast<uint32_t>(a) << 18 | static_cast<uint32_t>(b) << 12
+				| static_cast<uint32_t>(c) << 6 | static_cast<uint32_t>(d);
+			out[0] = static_cast<char>(group >> 16);
+			out[1] = static_cast<char>(group >> 8);
+			out[2] = static_cast<char>(group);
+		}
+
+		// the chars before a padding error are checked first
+		for (const char* rest = it; rest != end; ++rest)
+		{
+			if (values[*rest] < 0) return rest - begin;
+		}
+		if (padding_error != -1) return padding_error;
+
+		if (end - it >= 2)
+		{
+			uint32_t group = static_cast<uint32_t>(values[it[0]]) << 18 | static_cast<uint32_t>(values[it[1]]) << 12;
+			if (end - it == 3) group |= static_cast<uint32_t>(values[it[2]]) << 6;
+			*out++ = static_cast<char>(group >> 16);
+			if (end - it == 3) *out++ = static_cast<char>(group >> 8);
+		}
+		return -1;
+	}
+
+	ptrdiff_t base64_decode(const string_view& text, nativa::string& out, base64_alphabet alphabet)
+	{
+		const size_t size = base64_decoded_size(text);
+		if (size == 0)
+		{
+			const ptrdiff_t error = base64_decode(text, static_cast<char*>(nullptr), alphabet);
+			if (error == -1) out = string("");
+			return error;
+		}
+
+		char* mutable_raw;
+		auto res = string_internals::alloc(size, mutable_raw);
+		const ptrdiff_t error = base64_decode(text, mutable_raw, alphabet);
+		if (error == -1) out = std::move(res);
+		return error;
+	}
+
+	void hex_encode(const string_view& bytes, char* out, bool upper)
+	{
+		const char* const digits = upper ? upper_digits : lower_digits;
+
+		const uint8_t* it = reinterpret_cast<const uint8_t*>(bytes.begin());
+		const uint8_t* const end = reinterpret_cast<const uint8_t*>(bytes.end());
+
+#ifdef NATIVA_SIMD_AVX2
+		const __m256i lookup = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+		const __m256i nibble = _mm256_set1_epi8(0x0F);
+		for (; end - it >= 32; it += 32, out += 64)
+		{
+			const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+			const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+			const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(input, nibble));
+
+			// interleaving works within lanes, so the halves are put back in order
+			const __m256i first = _mm256_unpacklo_epi8(high, low);
+			const __m256i second = _mm256_unpackhi_epi8(high, low);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(first, second, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+		}
+#endif
+
+		for (; it != end; ++it, out += 2)
+		{
+			out[0] = digits[*it >> 4];
+			out[1] = digits[*it & 15];
+		}
+	}
+
+	nativa::string hex_encode(const string_view& bytes, bool upper)
+	{
+		if (bytes.is_empty()) return string("");
+
+		char* mutable_raw;
+		auto res = string_internals::alloc(bytes.size() * 2, mutable_raw);
+		hex_encode(bytes, mutable_raw, upper);
+		return std::move(res);
+	}
+
+	ptrdiff_t hex_decode(const string_view& text, char* out)
+	{
+		const char* const begin = text.begin();
+		const char* it = begin;
+		const char* const end = begin + (text.size() & ~size_t(1));
+
+#ifdef NATIVA_SIMD_AVX2
+		const __m256i weights = _mm256_set1_epi16(0x0110);
+		for (; end - it >= 64; it += 64, out += 32)
+		{
+			__m256i first, second;
+			const uint32_t first_valid = hex_values_of(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), first);
+			const uint32_t second_valid = hex_values_of(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + 32)), second);
+			if (first_valid != 0xFFFFFFFFu) return (it - begin) + simd::lowest_bit(~first_valid);
+			if (second_valid != 0xFFFFFFFFu) return (it - begin) + 32 + simd::lowest_bit(~second_valid);
+
+			// high * 16 + low in 16 bits, narrowed back to bytes, then the quarters put in order
+			const __m256i bytes = _mm256_packus_epi16(
+				_mm256_maddubs_epi16(first, weights), _mm256_maddubs_epi16(second, weights));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(bytes, 0xD8));
+		}
+#endif
+
+		for (; it != end; it += 2, ++out)
+		{
+			const int8_t high = hex_values[it[0]], low = hex_values[it[1]];
+			if ((high | low) < 0) return (it - begin) + (high < 0 ? 0 : 1);
+			*out = static_cast<char>(high << 4 | low);
+		}
+
+		if (end != text.end())
+		{
+			if (hex_values[*end] < 0) return end - begin;
+			return static_cast<ptrdiff_t>(text.size());
+		}
+		return -1;
+	}
+
+	ptrdiff_t hex_decode(const string_view& text, nativa::string& out)
+	{
+		const size_t size = text.size() / 2;
+		if (size == 0)
+		{
+			const ptrdiff_t error = hex_decode(text, static_cast<char*>(nullptr));
+			if (error == -1) out = string("");
+			return error;
+		}
+
+		char* mutable_raw;
+		auto res = string_internals::alloc(size, mutable_raw);
+		const ptrdiff_t error = hex_decode(text, mutable_raw);
+		if (error == -1) out = std::move(res);
+		return error;
+	}
+}
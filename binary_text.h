@@ -0,0 +1,84 @@
+#pragma once
+#ifndef NATIVA_BINARY_TEXT
+#define NATIVA_BINARY_TEXT
+
+#include <cstddef>
+#include "string.h"
+
+namespace nativa
+{
+	enum class base64_alphabet
+	{
+		// + and /, padded with = when encoding
+		standard,
+		// - and _, unpadded when encoding
+		url_safe,
+	};
+
+	/// <summary>
+	/// The number of chars base64_encode writes for the given number of bytes.
+	/// </summary>
+	size_t base64_encoded_size(size_t bytes, base64_alphabet alphabet = base64_alphabet::standard);
+
+	/// <summary>
+	/// The number of bytes base64_decode writes for the given text, if it is valid.
+	/// </summary>
+	size_t base64_decoded_size(const string_view& text);
+
+	/// <summary>
+	/// Encodes bytes in base64 into a caller buffer.
+	/// </summary>
+	/// <param name="bytes">The bytes to encode</param>
+	/// <param name="out">The buffer, of at least base64_encoded_size chars</param>
+	void base64_encode(const string_view& bytes, char* out, base64_alphabet alphabet = base64_alphabet::standard);
+
+	/// <summary>
+	/// Encodes bytes in base64 into a string of the exact size.
+	/// </summary>
+	nativa::string base64_encode(const string_view& bytes, base64_alphabet alphabet = base64_alphabet::standard);
+
+	/// <summary>
+	/// Decodes base64 text into a caller buffer.
+	/// The padding is optional for both alphabets, but must be right where present.
+	/// </summary>
+	/// <param name="text">The text to decode</param>
+	/// <param name="out">The buffer, of at least base64_decoded_size bytes</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the first char in error</returns>
+	ptrdiff_t base64_decode(const string_view& text, char* out, base64_alphabet alphabet = base64_alphabet::standard);
+
+	/// <summary>
+	/// Decodes base64 text into a string of the exact size.
+	/// </summary>
+	/// <param name="out">Receives the bytes; left untouched if the text is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the first char in error</returns>
+	ptrdiff_t base64_decode(const string_view& text, nativa::string& out, base64_alphabet alphabet = base64_alphabet::standard);
+
+	/// <summary>
+	/// Encodes bytes as two hex digits each into a caller buffer.
+	/// </summary>
+	/// <param name="out">The buffer, of at least twice as many chars as the bytes</param>
+	/// <param name="upper">Whether the digits above 9 are upper case</param>
+	void hex_encode(const string_view& bytes, char* out, bool upper = false);
+
+	/// <summary>
+	/// Encodes bytes as two hex digits each into a string of the exact size.
+	/// </summary>
+	nativa::string hex_encode(const string_view& bytes, bool upper = false);
+
+	/// <summary>
+	/// Decodes pairs of hex digits of either case into a caller buffer.
+	/// </summary>
+	/// <param name="out">The buffer, of at least half as many bytes as the chars</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the first char in error,
+	/// which is the size of the text if a digit is missing at its end</returns>
+	ptrdiff_t hex_decode(const string_view& text, char* out);
+
+	/// <summary>
+	/// Decodes pairs of hex digits of either case into a string of the exact size.
+	/// </summary>
+	/// <param name="out">Receives the bytes; left untouched if the text is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the first char in error</returns>
+	ptrdiff_t hex_decode(const string_view& text, nativa::string& out);
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include <cassert>
+#include "char_set.h"
+#include "simd.h"
+
+namespace nativa
+{
+	char_set::char_set()
+		: m_bits{ 0, 0, 0, 0 }, m_listed{}, m_size(0), m_nibbles{}
+	{
+	}
+
+	char_set::char_set(const string_view& chars)
+		: char_set()
+	{
+		for (char c : chars) add(c);
+	}
+
+	void char_set::add(char c)
+	{
+		if (contains(c)) return;
+
+		const uint8_t byte = static_cast<uint8_t>(c);
+		m_bits[byte >> 6] |= uint64_t(1) << (byte & 63);
+		m_nibbles[byte >> 7][byte & 15] |= static_cast<uint8_t>(1 << ((byte >> 4) & 7));
+		if (m_size < max_listed) m_listed[m_size] = c;
+		++m_size;
+	}
+
+	const char_set& char_set::whitespace()
+	{
+		static const char_set res(" \t\n\v\f\r");
+		return res;
+	}
+
+	const char* char_set::find_in(const char* begin, const char* end) const
+	{
+		return scan<true, false>(begin, end);
+	}
+
+	const char* char_set::find_not_in(const char* begin, const char* end) const
+	{
+		return scan<false, false>(begin, end);
+	}
+
+	const char* char_set::find_last_not_in(const char* begin, const char* end) const
+	{
+		return scan<false, true>(begin, end);
+	}
+
+#ifdef NATIVA_SIMD_SSE2
+	namespace
+	{
+		/// <summary>
+		/// Scans 16 chars at a time, classify giving the mask of those in the set,
+		/// and narrows [begin, end) to the chars left for the scalar loop.
+		/// </summary>
+		/// <returns>Pointer to the char found, or nullptr if there is none in the blocks</returns>
+		template <bool Wanted, bool Backwards, typename Classify>
+		inline const char* scan_blocks(const char*& begin, const char*& end, Classify classify)
+		{
+			const uint32_t flip = Wanted ? 0 : 0xFFFF;
+			if (!Backwards)
+			{
+				for (; end - begin >= 16; begin += 16)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+					const uint32_t mask = classify(block) ^ flip;
+					if (mask != 0) return begin + simd::lowest_bit(mask);
+				}
+			}
+			else
+			{
+				for (; end - begin >= 16; end -= 16)
+				{
+					const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end - 16));
+					const uint32_t mask = classify(block) ^ flip;
+					if (mask != 0) return end - 16 + simd::highest_bit(mask);
+				}
+			}
+			return nullptr;
+		}
+	}
+#endif
+
+	template <bool Wanted, bool Backwards>
+	const char* char_set::scan(const char* begin, const char* end) const
+	{
+		const char* found = nullptr;
+#ifdef NATIVA_SIMD_SSE2
+		if (m_size <= max_listed)
+		{
+			// one compare per listed char
+			__m128i listed[max_listed];
+			for (size_t i = 0; i < m_size; ++i) listed[i] = _mm_set1_epi8(m_listed[i]);
+
+			found = scan_blocks<Wanted, Backwards>(begin, end, [&](__m128i block)
+			{
+				__m128i hit = _mm_setzero_si128();
+				for (size_t i = 0; i < m_size; ++i)
+				{
+					hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, listed[i]));
+				}
+				return static_cast<uint32_t>(_mm_movemask_epi8(hit));
+			});
+		}
+#ifdef NATIVA_SIMD_SSSE3
+		else
+		{
+			// the low nibble picks a row of high nibbles, the high one picks a bit in it
+			const __m128i low_rows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_nibbles[0]));
+			const __m128i high_rows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_nibbles[1]));
+			const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+			const __m128i nibble = _mm_set1_epi8(0x0F);
+			const __m128i seven = _mm_set1_epi8(7);
+
+			found = scan_blocks<Wanted, Backwards>(begin, end, [&](__m128i block)
+			{
+				const __m128i low = _mm_and_si128(block, nibble);
+				const __m128i high = _mm_and_si128(_mm_srli_epi16(block, 4), nibble);
+				const __m128i upper = _mm_cmpgt_epi8(high, seven);
+				const __m128i row = _mm_or_si128(
+					_mm_and_si128(upper, _mm_shuffle_epi8(high_rows, low)),
+					_mm_andnot_si128(upper, _mm_shuffle_epi8(low_rows, low)));
+				const __m128i bit = _mm_shuffle_epi8(bits, high);
+				const __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+				return static_cast<uint32_t>(_mm_movemask_epi8(hit));
+			});
+		}
+#endif
+#endif
+		if (found != nullptr) return found;
+
+		if (!Backwards)
+		{
+			while (begin != end && contains(*begin) != Wanted) ++begin;
+			return begin;
+		}
+		while (end != begin)
+		{
+			--end;
+			if (contains(*end) == Wanted) return end;
+		}
+		return nullptr;
+	}
+
+	ptrdiff_t string_view::find_first_of(const char_set& chars, size_t from) const
+	{
+		assert(from <= size());
+		const char* found = chars.find_in(m_begin + from, m_end);
+		return found == m_end ? -1 : found - m_begin;
+	}
+
+	ptrdiff_t string_view::find_first_not_of(const char_set& chars, size_t from) const
+	{
+		assert(from <= size());
+		const char* found = chars.find_not_in(m_begin + from, m_end);
+		return found == m_end ? -1 : found - m_begin;
+	}
+
+	size_t string_view::span(const char_set& chars) const
+	{
+		return static_cast<size_t>(chars.find_not_in(m_begin, m_end) - m_begin);
+	}
+
+	string_view string_view::trim(const char_set& chars) const
+	{
+		const char* begin = chars.find_not_in(m_begin, m_end);
+		if (begin == m_end) return string_view(m_end, m_end);
+		return string_view(begin, chars.find_last_not_in(begin, m_end) + 1);
+	}
+
+	string_view string_view::trim_start(const char_set& chars) const
+	{
+		return string_view(chars.find_not_in(m_begin, m_end), m_end);
+	}
+
+	string_view string_view::trim_end(const char_set& chars) const
+	{
+		const char* last = chars.find_last_not_in(m_begin, m_end);
+		if (last == nullptr) return string_view(m_begin, m_begin);
+		return string_view(m_begin, last + 1);
+	}
+
+	string_view string_view::trim() const
+	{
+		return trim(char_set::whitespace());
+	}
+
+	string_view string_view::trim_start() const
+	{
+		return trim_start(char_set::whitespace());
+	}
+
+	string_view string_view::trim_end() const
+	{
+		return trim_end(char_set::whitespace());
+	}
+}
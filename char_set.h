@@ -0,0 +1,120 @@
+#pragma once
+#ifndef NATIVA_CHAR_SET
+#define NATIVA_CHAR_SET
+
+#include <cstddef>
+#include <cstdint>
+#include "string_view.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// A set of chars compiled once for repeated scanning.
+	/// Keeps a 256-bit table, plus the chars themselves when there are few
+	/// enough of them to be compared in parallel, and otherwise a nibble table
+	/// looked up 16 chars at a time where SSSE3 is available.
+	/// </summary>
+	class char_set
+	{
+	public:
+		char_set();
+
+		/// <summary>
+		/// Creates the set of all the chars in the given string.
+		/// </summary>
+		/// <param name="chars">The chars, duplicates allowed</param>
+		char_set(const string_view& chars);
+
+		template <size_t N>
+		char_set(const char(&chars)[N]);
+
+		/// <summary>
+		/// The ASCII whitespace: space, \t, \n, \v, \f and \r.
+		/// </summary>
+		static const char_set& whitespace();
+
+		bool contains(char c) const;
+
+		size_t size() const;
+
+		/// <summary>
+		/// Finds the first char in the set.
+		/// </summary>
+		/// <returns>Pointer to the char found, or end if there is none</returns>
+		const char* find_in(const char* begin, const char* end) const;
+
+		/// <summary>
+		/// Finds the first char not in the set.
+		/// </summary>
+		/// <returns>Pointer to the char found, or end if there is none</returns>
+		const char* find_not_in(const char* begin, const char* end) const;
+
+		/// <summary>
+		/// Finds the last char not in the set.
+		/// </summary>
+		/// <returns>Pointer to the char found, or nullptr if there is none</returns>
+		const char* find_last_not_in(const char* begin, const char* end) const;
+
+	private:
+		static constexpr size_t max_listed = 8;
+
+		uint64_t m_bits[4];
+
+		char m_listed[max_listed];
+
+		size_t m_size;
+
+		/// <summary>
+		/// Bit (c >> 4) & 7 of m_nibbles[(c >> 7)][c & 15] is set for every c in the set,
+		/// one table for each half of the high nibbles, as a lane holds 8 bits.
+		/// </summary>
+		uint8_t m_nibbles[2][16];
+
+		void add(char c);
+
+		/// <summary>
+		/// Finds the first or last char in or not in the set.
+		/// </summary>
+		/// <returns>Pointer to the char found, or end (forwards) or nullptr (backwards) if there is none</returns>
+		template <bool Wanted, bool Backwards>
+		const char* scan(const char* begin, const char* end) const;
+	};
+
+	template <>
+	struct split_delimiter<char_set>
+	{
+		static const char* find(const char_set& delims, const char* begin, const char* end)
+		{
+			return delims.find_in(begin, end);
+		}
+
+		static size_t size(const char_set&)
+		{
+			return 1;
+		}
+	};
+
+	inline splitter<char_set> string_view::split_range(const char_set& delims, size_t max_splits, bool skip_empty) const
+	{
+		return splitter<char_set>(*this, delims, max_splits, skip_empty);
+	}
+
+	template <size_t N>
+	inline char_set::char_set(const char(&chars)[N])
+		: char_set(string_view(chars))
+	{
+	}
+
+	inline bool char_set::contains(char c) const
+	{
+		const uint8_t byte = static_cast<uint8_t>(c);
+		return (m_bits[byte >> 6] >> (byte & 63)) & 1;
+	}
+
+	inline size_t char_set::size() const
+	{
+		return m_size;
+	}
+}
+
+#endif
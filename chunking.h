@@ -0,0 +1,51 @@
+#pragma once
+#ifndef NATIVA_CHUNKING
+#define NATIVA_CHUNKING
+
+// Internal header cutting a large input into chunks, each handled on its own thread.
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace nativa
+{
+	namespace chunking
+	{
+		// below this each thread would spend more time starting than working
+		constexpr size_t min_chunk_size = size_t(1) << 20;
+
+		/// <summary>
+		/// How many chunks an input is cut into: one per thread, but none smaller than min_chunk_size.
+		/// </summary>
+		/// <param name="threads">How many threads may be used, 0 for one per hardware thread</param>
+		/// <returns>At least 1</returns>
+		inline size_t chunk_count(size_t size, size_t threads)
+		{
+			if (threads == 0) threads = std::thread::hardware_concurrency();
+			if (threads == 0) threads = 1;
+
+			size_t max_chunks = size / min_chunk_size;
+			if (max_chunks == 0) max_chunks = 1;
+			return threads < max_chunks ? threads : max_chunks;
+		}
+
+		/// <summary>
+		/// Runs task(0) ... task(count - 1), each on its own thread, the first on the calling one.
+		/// </summary>
+		template <typename Task>
+		void run_chunks(size_t count, const Task& task)
+		{
+			std::vector<std::thread> workers;
+			workers.reserve(count - 1);
+			for (size_t i = 1; i < count; ++i)
+			{
+				workers.emplace_back(task, i);
+			}
+			task(0);
+			for (auto& worker : workers) worker.join();
+		}
+	}
+}
+
+#endif
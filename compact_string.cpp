@@ -0,0 +1,102 @@
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include "compact_string.h"
+#include "instrumentation.h"
+
+namespace nativa
+{
+	compact_string::compact_string(const nativa::string& str)
+	{
+		string_header* block = string_internals::block_of(str);
+		if (block != nullptr)
+		{
+			NATIVA_COUNT(ref_increments);
+			block->counter += 1;
+			m_handle = reinterpret_cast<uintptr_t>(block);
+		}
+		else if (str.ref_count() == 0 && std::strlen(str.c_str()) == str.size())
+		{
+			// a literal, which lives as long as the program
+			m_handle = literal_handle(str.c_str(), str.size());
+		}
+		else
+		{
+			m_handle = clone_handle(str);
+		}
+	}
+
+	compact_string::compact_string(const string_view& str)
+		: m_handle(clone_handle(str))
+	{
+	}
+
+	compact_string::compact_string(const compact_string& str) noexcept
+		: m_handle(str.m_handle)
+	{
+		NATIVA_COUNT(copies);
+		if (!is_literal())
+		{
+			NATIVA_COUNT(ref_increments);
+			header()->counter += 1;
+		}
+	}
+
+	compact_string& compact_string::operator=(const compact_string& str) noexcept
+	{
+		if (&str == this) return *this;
+		compact_string copy(str);
+		std::swap(m_handle, copy.m_handle);
+		return *this;
+	}
+
+	nativa::string compact_string::to_string() const
+	{
+		if (!is_literal()) return string_internals::share_block(header());
+		const char* chars = literal();
+		return string_internals::of_literal(chars, chars + literal_size());
+	}
+
+	size_t compact_string::hash() const
+	{
+		if (is_literal()) return std::hash<string_view>()(view());
+
+		// a block from alloc holds a single string, so its header may cache the hash
+		string_header* block = header();
+		if (!(block->load_flags() & string_header::hash_cached))
+		{
+			block->store_cached(block->hash, std::hash<string_view>()(view()));
+			block->add_flags(string_header::hash_cached);
+		}
+		return block->load_cached(block->hash);
+	}
+
+	ref_counter_t compact_string::ref_count() const
+	{
+		return is_literal() ? 0 : header()->counter;
+	}
+
+	uint64_t compact_string::clone_handle(const string_view& str)
+	{
+		if (str.size() == 0) return literal_handle("", 0);
+
+		// the block of the clone outlives it, as the count is raised first
+		const nativa::string clone = str.clone();
+		string_header* block = string_internals::block_of(clone);
+		assert(block != nullptr);
+		NATIVA_COUNT(ref_increments);
+		block->counter += 1;
+		return reinterpret_cast<uintptr_t>(block);
+	}
+
+	void compact_string::release() noexcept
+	{
+		string_header* block = header();
+		NATIVA_COUNT(ref_decrements);
+		block->counter -= 1;
+		if (block->counter == 0)
+		{
+			string_internals::free_block(block, block->size + block->spare);
+		}
+	}
+}
@@ -0,0 +1,270 @@
+#pragma once
+#ifndef NATIVA_COMPACT_STRING
+#define NATIVA_COMPACT_STRING
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include "string.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// An immutable string in 8 bytes instead of the 24 of nativa::string,
+	/// for containers of very many strings.
+	/// It is a single pointer to the header of a runtime string, which holds the count
+	/// and the size with the chars right after, or to the chars of a literal, told apart by a tag bit.
+	/// Literals have no header; their size is kept in the top byte of the handle up to 254 chars,
+	/// and found by strlen past that, so they should not contain '\0'.
+	/// Each access to the size or the chars goes through the pointer,
+	/// which mostly lands on the same cache line as the chars.
+	/// The block of a runtime string is the one of nativa::string, whose 48-byte header also caches
+	/// the hash (which set lookups reuse) and tells how to release foreign blocks, so a string of 10 chars
+	/// costs 8 + 48 + 11 bytes, against 24 + 48 + 11 for nativa::string; it only saves the 16 bytes
+	/// of each handle, which matters where the strings are held many times over, such as in indexes.
+	/// The handles_build benchmark reports the bytes per string of both.
+	/// </summary>
+	class compact_string
+	{
+	public:
+		compact_string();
+
+		// Create from string literals.
+		template <size_t N>
+		compact_string(const char(&c_str)[N]);
+
+		/// <summary>
+		/// Shares the block of a runtime string made by string_internals::alloc,
+		/// and clones any other string, whose header does not know its size.
+		/// </summary>
+		compact_string(const nativa::string& str);
+
+		/// <summary>
+		/// Clones the chars.
+		/// </summary>
+		explicit compact_string(const string_view& str);
+
+		compact_string(const compact_string& str) noexcept;
+
+		compact_string(compact_string&& str) noexcept;
+
+		~compact_string() noexcept;
+
+		compact_string& operator=(const compact_string& str) noexcept;
+
+		compact_string& operator=(compact_string&& str) noexcept;
+
+		size_t size() const;
+
+		bool is_empty() const;
+
+		const char* begin() const;
+
+		const char* end() const;
+
+		const char* c_str() const;
+
+		string_view view() const;
+
+		operator string_view() const;
+
+		/// <summary>
+		/// Gets a nativa::string sharing the chars.
+		/// </summary>
+		nativa::string to_string() const;
+
+		/// <summary>
+		/// Gets the hash, equal to the std::hash of the view,
+		/// cached in the header of runtime strings like nativa::string::hash.
+		/// </summary>
+		size_t hash() const;
+
+		ref_counter_t ref_count() const;
+
+		bool operator==(const compact_string& right) const;
+
+		bool operator!=(const compact_string& right) const;
+
+		bool operator<(const compact_string& right) const;
+
+	private:
+		/// <summary>
+		/// The header pointer, whose low bits are zero as it is aligned,
+		/// or the literal pointer shifted up by one with the low bit set,
+		/// and the literal size, or long_literal, in the top byte.
+		/// 64 bits even where pointers are 32, so that the shift loses nothing.
+		/// </summary>
+		uint64_t m_handle;
+
+		static constexpr unsigned literal_size_shift = 56;
+
+		/// <summary>
+		/// The top byte of a literal too long to keep its size there.
+		/// </summary>
+		static constexpr uint64_t long_literal = 0xFF;
+
+		bool is_literal() const;
+
+		size_t literal_size() const;
+
+		string_header* header() const;
+
+		/// <summary>
+		/// The chars right after the header, as string_internals::chars_of finds them.
+		/// </summary>
+		const char* chars() const;
+
+		const char* literal() const;
+
+		static uint64_t literal_handle(const char* c_str, size_t size);
+
+		static uint64_t clone_handle(const string_view& str);
+
+		/// <summary>
+		/// Drops the count of a runtime string, freeing the block with the last one.
+		/// </summary>
+		void release() noexcept;
+	};
+
+	static_assert(sizeof(compact_string) == 8, "compact_string should be a single word");
+
+#pragma region Template and Inline Function Impl
+
+	template <size_t N>
+	inline compact_string::compact_string(const char(&c_str)[N])
+		: m_handle(literal_handle(c_str, N - 1))
+	{
+	}
+
+	inline compact_string::compact_string()
+		: m_handle(literal_handle("", 0))
+	{
+	}
+
+	inline compact_string::compact_string(compact_string&& str) noexcept
+		: m_handle(str.m_handle)
+	{
+		str.m_handle = literal_handle("", 0);
+	}
+
+	inline compact_string::~compact_string() noexcept
+	{
+		if (!is_literal()) release();
+	}
+
+	inline compact_string& compact_string::operator=(compact_string&& str) noexcept
+	{
+		if (&str == this) return *this;
+		if (!is_literal()) release();
+		m_handle = str.m_handle;
+		str.m_handle = literal_handle("", 0);
+		return *this;
+	}
+
+	inline size_t compact_string::size() const
+	{
+		return is_literal() ? literal_size() : header()->size;
+	}
+
+	inline bool compact_string::is_empty() const
+	{
+		// runtime strings are never empty
+		return is_literal() && *literal() == '\0';
+	}
+
+	inline const char* compact_string::begin() const
+	{
+		return is_literal() ? literal() : chars();
+	}
+
+	inline const char* compact_string::end() const
+	{
+		return is_literal() ? literal() + literal_size() : chars() + header()->size;
+	}
+
+	inline const char* compact_string::c_str() const
+	{
+		return begin();
+	}
+
+	inline string_view compact_string::view() const
+	{
+		return string_view(begin(), end());
+	}
+
+	inline compact_string::operator string_view() const
+	{
+		return view();
+	}
+
+	inline bool compact_string::operator==(const compact_string& right) const
+	{
+		if (m_handle == right.m_handle) return true;
+		return view() == right.view();
+	}
+
+	inline bool compact_string::operator!=(const compact_string& right) const
+	{
+		return !this->operator==(right);
+	}
+
+	inline bool compact_string::operator<(const compact_string& right) const
+	{
+		return view() < right.view();
+	}
+
+	inline bool compact_string::is_literal() const
+	{
+		return m_handle & 1;
+	}
+
+	inline size_t compact_string::literal_size() const
+	{
+		const uint64_t size = m_handle >> literal_size_shift;
+		return size != long_literal ? static_cast<size_t>(size) : std::strlen(literal());
+	}
+
+	inline string_header* compact_string::header() const
+	{
+		return reinterpret_cast<string_header*>(static_cast<uintptr_t>(m_handle));
+	}
+
+	inline const char* compact_string::chars() const
+	{
+		return reinterpret_cast<const char*>(header() + 1);
+	}
+
+	inline const char* compact_string::literal() const
+	{
+		const uint64_t address_bits = (uint64_t(1) << literal_size_shift) - 1;
+		return reinterpret_cast<const char*>(static_cast<uintptr_t>((m_handle & address_bits) >> 1));
+	}
+
+	inline uint64_t compact_string::literal_handle(const char* c_str, size_t size)
+	{
+		const uint64_t address = reinterpret_cast<uintptr_t>(c_str);
+		// user space addresses leave the top bits free, 57 of them at most are used with 5-level paging
+		assert(address >> (literal_size_shift - 1) == 0);
+		assert(std::strlen(c_str) == size);
+		const uint64_t tag = size < long_literal ? size : long_literal;
+		return tag << literal_size_shift | address << 1 | 1;
+	}
+
+#pragma endregion
+}
+
+namespace std
+{
+	template <>
+	struct hash<nativa::compact_string>
+	{
+		size_t operator()(const nativa::compact_string& str) const
+		{
+			return str.hash();
+		}
+	};
+}
+
+#endif
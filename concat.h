@@ -0,0 +1,278 @@
+#pragma once
+#ifndef NATIVA_CONCAT
+#define NATIVA_CONCAT
+
+#include <charconv>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include "string.h"
+#include "string_builder.h"
+
+namespace nativa
+{
+	template <typename... Parts>
+	class concat_expr;
+
+	template <typename T>
+	constexpr bool is_concat_expr = false;
+
+	template <typename... Parts>
+	constexpr bool is_concat_expr<concat_expr<Parts...>> = true;
+
+	namespace concat_impl
+	{
+		// literals, views and strings, whose chars are copied when the expression is materialized
+		struct view_part
+		{
+			string_view view;
+
+			size_t size() const;
+
+			char* write(char* out) const;
+		};
+
+		struct char_part
+		{
+			char c;
+
+			size_t size() const;
+
+			char* write(char* out) const;
+		};
+
+		// numbers are formatted by std::to_chars when the expression is built, so their size is known
+		struct number_part
+		{
+			// enough for the longest double, "-2.2250738585072014e-308"
+			char chars[32];
+			unsigned char length;
+
+			template <typename T>
+			explicit number_part(T value);
+
+			size_t size() const;
+
+			char* write(char* out) const;
+		};
+
+		// not for expressions, which would convert to a temporary string the view outlives
+		template <typename T>
+			requires std::is_convertible_v<const T&, string_view> && (!is_concat_expr<T>)
+		view_part part_of(const T& view);
+
+		template <typename T>
+			requires std::is_same_v<T, char>
+		char_part part_of(T c);
+
+		template <typename T>
+			requires std::is_arithmetic_v<T> && (!std::is_same_v<T, char>) && (!std::is_same_v<T, bool>)
+		number_part part_of(T value);
+
+		template <typename T>
+		using part_t = decltype(part_of(std::declval<const T&>()));
+	}
+
+	/// <summary>
+	/// What may be concatenated: literals, string_views, strings, chars and numbers other than bool.
+	/// Expressions are joined by their own operator+ instead.
+	/// </summary>
+	template <typename T>
+	concept concat_operand = !is_concat_expr<T> && requires(const T& value) { concat_impl::part_of(value); };
+
+	/// <summary>
+	/// A concatenation not done yet, made by operator+ on views and strings.
+	/// Converting it to a string sums the sizes of the parts first and copies them into one block
+	/// from string_internals::alloc; appending it to a builder grows the builder once.
+	/// The views are not owned, so the expression should be converted before the operands go away,
+	/// such as within the statement building it.
+	/// </summary>
+	template <typename... Parts>
+	class concat_expr
+	{
+	public:
+		explicit concat_expr(std::tuple<Parts...> parts);
+
+		size_t size() const;
+
+		/// <summary>
+		/// Copies the parts one after another.
+		/// </summary>
+		/// <param name="out">Where to copy to, which should have room for size() chars</param>
+		/// <returns>The end of the chars written</returns>
+		char* write(char* out) const;
+
+		nativa::string to_string() const;
+
+		operator nativa::string() const;
+
+		const std::tuple<Parts...>& parts() const;
+
+	private:
+		std::tuple<Parts...> m_parts;
+	};
+
+	/// <summary>
+	/// Starts a concatenation; one of the operands should be a view or a string,
+	/// so that additions of literals, pointers and numbers keep their meaning.
+	/// Note that a string plus a number or a char is a concatenation too,
+	/// not the pointer arithmetic it was through string's conversion to const char*.
+	/// </summary>
+	template <typename Left, typename Right>
+		requires (std::is_base_of_v<string_view, Left> || std::is_base_of_v<string_view, Right>)
+			&& concat_operand<Left> && concat_operand<Right>
+	concat_expr<concat_impl::part_t<Left>, concat_impl::part_t<Right>> operator+(const Left& left, const Right& right);
+
+	template <typename... Parts, typename Right>
+		requires concat_operand<Right>
+	concat_expr<Parts..., concat_impl::part_t<Right>> operator+(const concat_expr<Parts...>& left, const Right& right);
+
+	template <typename Left, typename... Parts>
+		requires concat_operand<Left>
+	concat_expr<concat_impl::part_t<Left>, Parts...> operator+(const Left& left, const concat_expr<Parts...>& right);
+
+	template <typename... Left, typename... Right>
+	concat_expr<Left..., Right...> operator+(const concat_expr<Left...>& left, const concat_expr<Right...>& right);
+
+#pragma region Template and Inline Function Impl
+
+	inline size_t concat_impl::view_part::size() const
+	{
+		return view.size();
+	}
+
+	inline char* concat_impl::view_part::write(char* out) const
+	{
+		view.copy_to(out);
+		return out + view.size();
+	}
+
+	inline size_t concat_impl::char_part::size() const
+	{
+		return 1;
+	}
+
+	inline char* concat_impl::char_part::write(char* out) const
+	{
+		*out = c;
+		return out + 1;
+	}
+
+	template <typename T>
+	inline concat_impl::number_part::number_part(T value)
+	{
+		// cannot fail, as the buffer is large enough for any arithmetic type
+		auto res = std::to_chars(chars, chars + sizeof(chars), value);
+		length = static_cast<unsigned char>(res.ptr - chars);
+	}
+
+	inline size_t concat_impl::number_part::size() const
+	{
+		return length;
+	}
+
+	inline char* concat_impl::number_part::write(char* out) const
+	{
+		for (unsigned char i = 0; i < length; ++i) out[i] = chars[i];
+		return out + length;
+	}
+
+	template <typename T>
+		requires std::is_convertible_v<const T&, string_view> && (!is_concat_expr<T>)
+	inline concat_impl::view_part concat_impl::part_of(const T& view)
+	{
+		return view_part{ view };
+	}
+
+	template <typename T>
+		requires std::is_same_v<T, char>
+	inline concat_impl::char_part concat_impl::part_of(T c)
+	{
+		return char_part{ c };
+	}
+
+	template <typename T>
+		requires std::is_arithmetic_v<T> && (!std::is_same_v<T, char>) && (!std::is_same_v<T, bool>)
+	inline concat_impl::number_part concat_impl::part_of(T value)
+	{
+		return number_part(value);
+	}
+
+	template <typename... Parts>
+	inline concat_expr<Parts...>::concat_expr(std::tuple<Parts...> parts)
+		: m_parts(std::move(parts))
+	{
+	}
+
+	template <typename... Parts>
+	inline size_t concat_expr<Parts...>::size() const
+	{
+		return std::apply([](const auto&... part) { return (part.size() + ... + size_t(0)); }, m_parts);
+	}
+
+	template <typename... Parts>
+	inline char* concat_expr<Parts...>::write(char* out) const
+	{
+		std::apply([&out](const auto&... part) { ((out = part.write(out)), ...); }, m_parts);
+		return out;
+	}
+
+	template <typename... Parts>
+	inline nativa::string concat_expr<Parts...>::to_string() const
+	{
+		const size_t size = this->size();
+		if (size == 0) return "";
+
+		char* buffer;
+		auto res = string_internals::alloc(size, buffer);
+		write(buffer);
+		return res;
+	}
+
+	template <typename... Parts>
+	inline concat_expr<Parts...>::operator nativa::string() const
+	{
+		return to_string();
+	}
+
+	template <typename... Parts>
+	inline const std::tuple<Parts...>& concat_expr<Parts...>::parts() const
+	{
+		return m_parts;
+	}
+
+	template <typename Left, typename Right>
+		requires (std::is_base_of_v<string_view, Left> || std::is_base_of_v<string_view, Right>)
+			&& concat_operand<Left> && concat_operand<Right>
+	inline concat_expr<concat_impl::part_t<Left>, concat_impl::part_t<Right>> operator+(const Left& left, const Right& right)
+	{
+		using concat_impl::part_of;
+		return concat_expr<concat_impl::part_t<Left>, concat_impl::part_t<Right>>(std::make_tuple(part_of(left), part_of(right)));
+	}
+
+	template <typename... Parts, typename Right>
+		requires concat_operand<Right>
+	inline concat_expr<Parts..., concat_impl::part_t<Right>> operator+(const concat_expr<Parts...>& left, const Right& right)
+	{
+		return concat_expr<Parts..., concat_impl::part_t<Right>>(
+			std::tuple_cat(left.parts(), std::make_tuple(concat_impl::part_of(right))));
+	}
+
+	template <typename Left, typename... Parts>
+		requires concat_operand<Left>
+	inline concat_expr<concat_impl::part_t<Left>, Parts...> operator+(const Left& left, const concat_expr<Parts...>& right)
+	{
+		return concat_expr<concat_impl::part_t<Left>, Parts...>(
+			std::tuple_cat(std::make_tuple(concat_impl::part_of(left)), right.parts()));
+	}
+
+	template <typename... Left, typename... Right>
+	inline concat_expr<Left..., Right...> operator+(const concat_expr<Left...>& left, const concat_expr<Right...>& right)
+	{
+		return concat_expr<Left..., Right...>(std::tuple_cat(left.parts(), right.parts()));
+	}
+
+#pragma endregion
+}
+
+#endif
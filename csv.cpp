@@ -0,0 +1,191 @@
+#include <cstring>
+#include "csv.h"
+#include "simd.h"
+
+namespace nativa
+{
+	namespace
+	{
+		/// <summary>
+		/// Bitmasks of where three chars are in a block of 64.
+		/// </summary>
+		struct block_masks
+		{
+			uint64_t delims;
+			uint64_t quotes;
+			uint64_t newlines;
+		};
+
+		block_masks classify_block(const char* at, char delim, char quote)
+		{
+			block_masks res;
+#if defined(NATIVA_SIMD_AVX2)
+			const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at));
+			const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(at + 32));
+			auto mask_of = [&](char c)
+			{
+				const __m256i target = _mm256_set1_epi8(c);
+				return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, target))))
+					| static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, target)))) << 32;
+			};
+#elif defined(NATIVA_SIMD_SSE2)
+			__m128i chunks[4];
+			for (int i = 0; i < 4; ++i) chunks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at + 16 * i));
+			auto mask_of = [&](char c)
+			{
+				const __m128i target = _mm_set1_epi8(c);
+				uint64_t mask = 0;
+				for (int i = 0; i < 4; ++i)
+				{
+					mask |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], target))) << (16 * i);
+				}
+				return mask;
+			};
+#else
+			auto mask_of = [&](char c)
+			{
+				uint64_t mask = 0;
+				for (int i = 0; i < 64; ++i)
+				{
+					mask |= static_cast<uint64_t>(at[i] == c) << i;
+				}
+				return mask;
+			};
+#endif
+			res.delims = mask_of(delim);
+			res.quotes = quote != '\0' ? mask_of(quote) : 0;
+			res.newlines = mask_of('\n');
+			return res;
+		}
+
+		/// <summary>
+		/// Every bit becomes the xor of itself and all bits below it,
+		/// which turns the quotes into the chars after an odd number of them.
+		/// </summary>
+		inline uint64_t prefix_xor(uint64_t bits)
+		{
+#ifdef NATIVA_SIMD_CLMUL
+			// a carry-less multiplication by all ones
+			const __m128i product = _mm_clmulepi64_si128(
+				_mm_set_epi64x(0, static_cast<long long>(bits)), _mm_set1_epi8(static_cast<char>(0xFF)), 0);
+			return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+			bits ^= bits << 1;
+			bits ^= bits << 2;
+			bits ^= bits << 4;
+			bits ^= bits << 8;
+			bits ^= bits << 16;
+			bits ^= bits << 32;
+			return bits;
+#endif
+		}
+	}
+
+	csv_parser::csv_parser(const string_view& text, char delim, char quote)
+		: m_begin(text.begin()), m_end(text.end()), m_delim(delim), m_quote(quote),
+		m_field(text.begin()), m_block(text.begin()), m_next_block(0), m_structurals(0), m_in_quotes(0)
+	{
+	}
+
+	bool csv_parser::next(std::vector<nativa::string_view>& fields)
+	{
+		fields.clear();
+		m_scratch.clear();
+		m_unescaped.clear();
+		if (m_field == m_end) return false;
+
+		while (true)
+		{
+			const char* at = next_structural();
+			const bool line_end = at == m_end || *at == '\n';
+			add_field(m_field, at, line_end, fields);
+			if (at == m_end)
+			{
+				m_field = m_end;
+				break;
+			}
+			m_field = at + 1;
+			if (line_end) break;
+		}
+
+		// the scratch may have moved while it grew, so the views are made last
+		for (const auto& field : m_unescaped)
+		{
+			const char* begin = m_scratch.data() + field.offset;
+			fields[field.index] = string_view(begin, begin + field.size);
+		}
+		return true;
+	}
+
+	const char* csv_parser::next_structural()
+	{
+		while (m_structurals == 0)
+		{
+			if (m_next_block >= static_cast<size_t>(m_end - m_begin)) return m_end;
+			classify();
+		}
+		const char* res = m_block + simd::lowest_bit(m_structurals);
+		m_structurals &= m_structurals - 1;
+		return res;
+	}
+
+	void csv_parser::classify()
+	{
+		m_block = m_begin + m_next_block;
+		const size_t available = m_end - m_block;
+		m_next_block += 64;
+
+		block_masks masks;
+		if (available >= 64)
+		{
+			masks = classify_block(m_block, m_delim, m_quote);
+		}
+		else
+		{
+			char padded[64] = {};
+			std::memcpy(padded, m_block, available);
+			masks = classify_block(padded, m_delim, m_quote);
+			const uint64_t valid = (uint64_t(1) << available) - 1;
+			masks.delims &= valid;
+			masks.quotes &= valid;
+			masks.newlines &= valid;
+		}
+
+		const uint64_t in_quotes = prefix_xor(masks.quotes) ^ m_in_quotes;
+		m_in_quotes = static_cast<uint64_t>(static_cast<int64_t>(in_quotes) >> 63);
+		m_structurals = (masks.delims | masks.newlines) & ~in_quotes;
+	}
+
+	void csv_parser::add_field(const char* begin, const char* end, bool line_end, std::vector<nativa::string_view>& fields)
+	{
+		if (line_end && end != begin && end[-1] == '\r') --end;
+		if (m_quote == '\0' || begin == end || *begin != m_quote)
+		{
+			fields.emplace_back(begin, end);
+			return;
+		}
+
+		// a missing closing quote leaves the rest of the text in the field
+		++begin;
+		if (end != begin && end[-1] == m_quote) --end;
+		const char* quote = static_cast<const char*>(std::memchr(begin, m_quote, end - begin));
+		if (quote == nullptr)
+		{
+			fields.emplace_back(begin, end);
+			return;
+		}
+
+		// copy the runs up to and with each quote, skipping the quote doubling it
+		const size_t offset = m_scratch.size();
+		while (quote != nullptr)
+		{
+			m_scratch.append(begin, quote + 1);
+			begin = quote + 1;
+			if (begin != end && *begin == m_quote) ++begin;
+			quote = static_cast<const char*>(std::memchr(begin, m_quote, end - begin));
+		}
+		m_scratch.append(begin, end);
+		m_unescaped.push_back({ fields.size(), offset, m_scratch.size() - offset });
+		fields.emplace_back();
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef NATIVA_CSV
+#define NATIVA_CSV
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "string_view.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Reads the records of CSV or TSV text in one pass, without splitting lines first.
+	/// Delimiters, quotes and newlines are found 64 chars at a time as bitmasks,
+	/// quoted stretches masked out by a prefix xor of the quotes,
+	/// so the fields are cut at the structural chars left.
+	/// Unquoted fields and quoted fields without doubled quotes are views into the text;
+	/// only fields with doubled quotes are unescaped, into a buffer of the parser.
+	/// </summary>
+	class csv_parser
+	{
+	public:
+		/// <summary>
+		/// Creates a parser over text, which is not copied and must outlive it.
+		/// </summary>
+		/// <param name="text">The records, ended by \n or \r\n, the last one needing no newline</param>
+		/// <param name="delim">The char between fields, ',' for CSV and '\t' for TSV</param>
+		/// <param name="quote">The char quoting fields, or '\0' if fields are never quoted</param>
+		csv_parser(const string_view& text, char delim = ',', char quote = '"');
+
+		csv_parser(const csv_parser&) = delete;
+
+		csv_parser& operator=(const csv_parser&) = delete;
+
+		/// <summary>
+		/// Reads the next record.
+		/// A quote opens or closes quoting wherever it is, as in most fast parsers,
+		/// but a field is unquoted only if it starts with one.
+		/// An empty line is a record of one empty field.
+		/// </summary>
+		/// <param name="fields">Cleared, then given the fields, which are valid
+		/// until the next call if they had doubled quotes, and as long as the text otherwise</param>
+		/// <returns>false if the text is used up</returns>
+		bool next(std::vector<nativa::string_view>& fields);
+
+	private:
+		struct unescaped_field
+		{
+			size_t index;
+			size_t offset;
+			size_t size;
+		};
+
+		const char* m_begin;
+
+		const char* m_end;
+
+		char m_delim;
+
+		char m_quote;
+
+		/// <summary>
+		/// Where the field being read begins
+		/// </summary>
+		const char* m_field;
+
+		/// <summary>
+		/// The block whose structural chars are in m_structurals
+		/// </summary>
+		const char* m_block;
+
+		/// <summary>
+		/// Where the next block begins, as an offset as it may be past the end
+		/// </summary>
+		size_t m_next_block;
+
+		/// <summary>
+		/// The delimiters and newlines of the block not yet consumed, one bit a char
+		/// </summary>
+		uint64_t m_structurals;
+
+		/// <summary>
+		/// All ones if the last block ended inside quotes
+		/// </summary>
+		uint64_t m_in_quotes;
+
+		std::string m_scratch;
+
+		std::vector<unescaped_field> m_unescaped;
+
+		/// <summary>
+		/// Finds the next delimiter or newline outside quotes.
+		/// </summary>
+		/// <returns>The char, or the end of the text if there is none</returns>
+		const char* next_structural();
+
+		/// <summary>
+		/// Sets m_structurals from the block at m_next_block.
+		/// </summary>
+		void classify();
+
+		void add_field(const char* begin, const char* end, bool line_end, std::vector<nativa::string_view>& fields);
+	};
+}
+
+#endif
@@ -0,0 +1,482 @@
+#include <cstdint>
+#include <cstring>
+#include "escape.h"
+#include "simd.h"
+
+namespace nativa
+{
+	namespace
+	{
+		enum class dialect
+		{
+			json,
+			c,
+		};
+
+		inline bool needs_escape(dialect d, uint8_t c)
+		{
+			return c < 0x20 || c == '"' || c == '\\' || (d == dialect::c && c == 0x7F);
+		}
+
+#ifdef NATIVA_SIMD_SSE2
+		/// <summary>
+		/// 0xFF for every char needing an escape.
+		/// </summary>
+		template <dialect D>
+		inline __m128i escape_bytes(__m128i chunk)
+		{
+			// unsigned c <= 0x1F is min(c, 0x1F) == c
+			__m128i res = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(0x1F)), chunk);
+			res = _mm_or_si128(res, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+			res = _mm_or_si128(res, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+			if (D == dialect::c) res = _mm_or_si128(res, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(0x7F)));
+			return res;
+		}
+#endif
+
+#ifdef NATIVA_SIMD_AVX2
+		template <dialect D>
+		inline __m256i escape_bytes(__m256i chunk)
+		{
+			__m256i res = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, _mm256_set1_epi8(0x1F)), chunk);
+			res = _mm256_or_si256(res, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')));
+			res = _mm256_or_si256(res, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+			if (D == dialect::c) res = _mm256_or_si256(res, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(0x7F)));
+			return res;
+		}
+#endif
+
+		/// <summary>
+		/// Finds the first char needing an escape, 64 chars an iteration
+		/// with one branch, as escapes are rare in most text.
+		/// </summary>
+		/// <returns>The char, or end if there is none</returns>
+		template <dialect D>
+		const char* find_escape(const char* it, const char* end)
+		{
+#if defined(NATIVA_SIMD_AVX2)
+			for (; end - it >= 64; it += 64)
+			{
+				const __m256i low = escape_bytes<D>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)));
+				const __m256i high = escape_bytes<D>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + 32)));
+				const __m256i any = _mm256_or_si256(low, high);
+				if (!_mm256_testz_si256(any, any))
+				{
+					const uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(low))
+						| static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32;
+					return it + simd::lowest_bit(mask);
+				}
+			}
+#elif defined(NATIVA_SIMD_SSE2)
+			for (; end - it >= 64; it += 64)
+			{
+				const __m128i a = escape_bytes<D>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)));
+				const __m128i b = escape_bytes<D>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 16)));
+				const __m128i c = escape_bytes<D>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 32)));
+				const __m128i d = escape_bytes<D>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 48)));
+				if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0)
+				{
+					const uint64_t mask = static_cast<uint64_t>(_mm_movemask_epi8(a))
+						| static_cast<uint64_t>(_mm_movemask_epi8(b)) << 16
+						| static_cast<uint64_t>(_mm_movemask_epi8(c)) << 32
+						| static_cast<uint64_t>(_mm_movemask_epi8(d)) << 48;
+					return it + simd::lowest_bit(mask);
+				}
+			}
+#endif
+#ifdef NATIVA_SIMD_SSE2
+			for (; end - it >= 16; it += 16)
+			{
+				const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+					escape_bytes<D>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)))));
+				if (mask != 0) return it + simd::lowest_bit(mask);
+			}
+#endif
+			for (; it != end; ++it)
+			{
+				if (needs_escape(D, static_cast<uint8_t>(*it))) return it;
+			}
+			return end;
+		}
+
+		/// <summary>
+		/// The letter of the two char escape of a char, or 0 if it has none.
+		/// </summary>
+		inline char short_escape(dialect d, uint8_t c)
+		{
+			switch (c)
+			{
+			case '"': return '"';
+			case '\\': return '\\';
+			case '\b': return 'b';
+			case '\f': return 'f';
+			case '\n': return 'n';
+			case '\r': return 'r';
+			case '\t': return 't';
+			case '\a': return d == dialect::c ? 'a' : 0;
+			case '\v': return d == dialect::c ? 'v' : 0;
+			default: return 0;
+			}
+		}
+
+		inline size_t escape_size(dialect d, uint8_t c)
+		{
+			if (short_escape(d, c) != 0) return 2;
+			// \u00XX or \ooo
+			return d == dialect::json ? 6 : 4;
+		}
+
+		const char hex_digits[] = "0123456789abcdef";
+
+		inline char* write_escape(dialect d, uint8_t c, char* out)
+		{
+			*out++ = '\\';
+			const char letter = short_escape(d, c);
+			if (letter != 0)
+			{
+				*out++ = letter;
+			}
+			else if (d == dialect::json)
+			{
+				*out++ = 'u';
+				*out++ = '0';
+				*out++ = '0';
+				*out++ = hex_digits[c >> 4];
+				*out++ = hex_digits[c & 0xF];
+			}
+			else
+			{
+				// always 3 digits, so a digit after it is not taken in
+				*out++ = static_cast<char>('0' + (c >> 6));
+				*out++ = static_cast<char>('0' + ((c >> 3) & 7));
+				*out++ = static_cast<char>('0' + (c & 7));
+			}
+			return out;
+		}
+
+		/// <summary>
+		/// The size of the escaped text, from its first char needing an escape.
+		/// </summary>
+		template <dialect D>
+		size_t escaped_size(const char* first, const char* end)
+		{
+			size_t res = end - first;
+			for (const char* it = first; it != end; it = find_escape<D>(it + 1, end))
+			{
+				res += escape_size(D, static_cast<uint8_t>(*it)) - 1;
+			}
+			return res;
+		}
+
+		/// <summary>
+		/// Writes the escaped text, from its first char needing an escape,
+		/// copying the runs between the escapes in bulk.
+		/// </summary>
+		template <dialect D>
+		void write_escaped(const char* first, const char* end, char* out)
+		{
+			const char* it = first;
+			while (true)
+			{
+				out = write_escape(D, static_cast<uint8_t>(*it), out);
+				const char* next = find_escape<D>(++it, end);
+				std::memcpy(out, it, next - it);
+				out += next - it;
+				if (next == end) break;
+				it = next;
+			}
+		}
+
+		/// <summary>
+		/// Escapes into a new string, the text having at least one char needing it.
+		/// </summary>
+		template <dialect D>
+		nativa::string escape_from(const string_view& text, const char* first)
+		{
+			const size_t prefix = first - text.begin();
+			char* mutable_raw;
+			auto res = string_internals::alloc(prefix + escaped_size<D>(first, text.end()), mutable_raw);
+			std::memcpy(mutable_raw, text.begin(), prefix);
+			write_escaped<D>(first, text.end(), mutable_raw + prefix);
+			return res;
+		}
+
+		template <dialect D>
+		void escape_into(const string_view& text, string_builder& out)
+		{
+			const char* first = find_escape<D>(text.begin(), text.end());
+			const size_t prefix = first - text.begin();
+			if (first == text.end())
+			{
+				out.append(text);
+				return;
+			}
+
+			const size_t old_size = out.size();
+			out.resize(old_size + prefix + escaped_size<D>(first, text.end()));
+			char* at = &*out.begin() + old_size;
+			std::memcpy(at, text.begin(), prefix);
+			write_escaped<D>(first, text.end(), at + prefix);
+		}
+
+		const int8_t* hex_values()
+		{
+			static const struct table
+			{
+				int8_t values[256];
+
+				table()
+				{
+					for (auto& value : values) value = -1;
+					for (int i = 0; i < 10; ++i) values['0' + i] = static_cast<int8_t>(i);
+					for (int i = 0; i < 6; ++i)
+					{
+						values['a' + i] = static_cast<int8_t>(10 + i);
+						values['A' + i] = static_cast<int8_t>(10 + i);
+					}
+				}
+			} res;
+			return res.values;
+		}
+
+		/// <summary>
+		/// One escape read from the text.
+		/// </summary>
+		struct unescaped
+		{
+			// the char after the escape, nullptr if the escape is bad
+			const char* next;
+			char chars[4];
+			unsigned size;
+		};
+
+		/// <summary>
+		/// Reads 4 hex digits.
+		/// </summary>
+		/// <returns>The value, or -1 if they are not all there</returns>
+		inline int32_t read_hex4(const char* at, const char* end)
+		{
+			if (end - at < 4) return -1;
+			const int8_t* values = hex_values();
+			int32_t res = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				const int8_t value = values[static_cast<uint8_t>(at[i])];
+				if (value < 0) return -1;
+				res = res << 4 | value;
+			}
+			return res;
+		}
+
+		inline unescaped one_char(const char* next, char c)
+		{
+			return { next, { c }, 1 };
+		}
+
+		/// <summary>
+		/// Reads the JSON escape starting at a backslash.
+		/// </summary>
+		unescaped unescape_one_json(const char* at, const char* end)
+		{
+			const unescaped bad = { nullptr, {}, 0 };
+			if (end - at < 2) return bad;
+
+			switch (at[1])
+			{
+			case '"': return one_char(at + 2, '"');
+			case '\\': return one_char(at + 2, '\\');
+			case '/': return one_char(at + 2, '/');
+			case 'b': return one_char(at + 2, '\b');
+			case 'f': return one_char(at + 2, '\f');
+			case 'n': return one_char(at + 2, '\n');
+			case 'r': return one_char(at + 2, '\r');
+			case 't': return one_char(at + 2, '\t');
+			case 'u': break;
+			default: return bad;
+			}
+
+			int32_t code_point = read_hex4(at + 2, end);
+			const char* next = at + 6;
+			if (code_point < 0) return bad;
+			if (code_point >= 0xDC00 && code_point <= 0xDFFF) return bad;
+			if (code_point >= 0xD800 && code_point <= 0xDBFF)
+			{
+				// the low surrogate must follow right away
+				if (end - next < 2 || next[0] != '\\' || next[1] != 'u') return bad;
+				const int32_t low = read_hex4(next + 2, end);
+				if (low < 0xDC00 || low > 0xDFFF) return bad;
+				code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+				next += 6;
+			}
+
+			unescaped res = { next, {}, 0 };
+			res.size = code_point < 0x80 ? 1 : code_point < 0x800 ? 2 : code_point < 0x10000 ? 3 : 4;
+			encoding::utf8::encode(static_cast<char32_t>(code_point), res.chars);
+			return res;
+		}
+
+		/// <summary>
+		/// Reads the C escape starting at a backslash.
+		/// </summary>
+		unescaped unescape_one_c(const char* at, const char* end)
+		{
+			const unescaped bad = { nullptr, {}, 0 };
+			if (end - at < 2) return bad;
+
+			switch (at[1])
+			{
+			case '"': return one_char(at + 2, '"');
+			case '\'': return one_char(at + 2, '\'');
+			case '?': return one_char(at + 2, '?');
+			case '\\': return one_char(at + 2, '\\');
+			case 'a': return one_char(at + 2, '\a');
+			case 'b': return one_char(at + 2, '\b');
+			case 'f': return one_char(at + 2, '\f');
+			case 'n': return one_char(at + 2, '\n');
+			case 'r': return one_char(at + 2, '\r');
+			case 't': return one_char(at + 2, '\t');
+			case 'v': return one_char(at + 2, '\v');
+			case 'x':
+			{
+				const int8_t* values = hex_values();
+				const char* it = at + 2;
+				unsigned value = 0;
+				for (; it != end && values[static_cast<uint8_t>(*it)] >= 0; ++it)
+				{
+					value = value << 4 | values[static_cast<uint8_t>(*it)];
+					if (value > 0xFF) return bad;
+				}
+				if (it == at + 2) return bad;
+				return one_char(it, static_cast<char>(value));
+			}
+			default:
+			{
+				const char* it = at + 1;
+				unsigned value = 0;
+				for (; it != end && it != at + 4 && *it >= '0' && *it <= '7'; ++it)
+				{
+					value = value << 3 | (*it - '0');
+				}
+				if (it == at + 1 || value > 0xFF) return bad;
+				return one_char(it, static_cast<char>(value));
+			}
+			}
+		}
+
+		/// <summary>
+		/// Unescapes with two passes, the first checking the escapes and
+		/// sizing the result, so the string is allocated once at its exact size.
+		/// </summary>
+		/// <param name="shared">The text as a string to share if it has no escapes, or nullptr</param>
+		template <unescaped(*UnescapeOne)(const char*, const char*)>
+		ptrdiff_t unescape(const string_view& text, const nativa::string* shared, nativa::string& out)
+		{
+			const char* const begin = text.begin();
+			const char* const end = text.end();
+			auto find_backslash = [end](const char* since)
+			{
+				auto res = std::memchr(since, '\\', end - since);
+				return res == nullptr ? end : static_cast<const char*>(res);
+			};
+
+			const char* first = find_backslash(begin);
+			if (first == end)
+			{
+				out = shared != nullptr ? *shared : text.clone();
+				return -1;
+			}
+
+			size_t size = first - begin;
+			for (const char* it = first; it != end;)
+			{
+				const unescaped one = UnescapeOne(it, end);
+				if (one.next == nullptr) return it - begin;
+				size += one.size;
+				const char* next = find_backslash(one.next);
+				size += next - one.next;
+				it = next;
+			}
+
+			if (size == 0)
+			{
+				out = "";
+				return -1;
+			}
+
+			char* mutable_raw;
+			auto res = string_internals::alloc(size, mutable_raw);
+			std::memcpy(mutable_raw, begin, first - begin);
+			mutable_raw += first - begin;
+			for (const char* it = first; it != end;)
+			{
+				const unescaped one = UnescapeOne(it, end);
+				std::memcpy(mutable_raw, one.chars, one.size);
+				mutable_raw += one.size;
+				const char* next = find_backslash(one.next);
+				std::memcpy(mutable_raw, one.next, next - one.next);
+				mutable_raw += next - one.next;
+				it = next;
+			}
+			out = std::move(res);
+			return -1;
+		}
+	}
+
+	nativa::string escape_json(const nativa::string& text)
+	{
+		const char* first = find_escape<dialect::json>(text.begin(), text.end());
+		if (first == text.end()) return text;
+		return escape_from<dialect::json>(text, first);
+	}
+
+	nativa::string escape_json(const string_view& text)
+	{
+		const char* first = find_escape<dialect::json>(text.begin(), text.end());
+		if (first == text.end()) return text.clone();
+		return escape_from<dialect::json>(text, first);
+	}
+
+	void escape_json(const string_view& text, string_builder& out)
+	{
+		escape_into<dialect::json>(text, out);
+	}
+
+	ptrdiff_t unescape_json(const string_view& text, nativa::string& out)
+	{
+		return unescape<unescape_one_json>(text, nullptr, out);
+	}
+
+	ptrdiff_t unescape_json(const nativa::string& text, nativa::string& out)
+	{
+		return unescape<unescape_one_json>(text, &text, out);
+	}
+
+	nativa::string escape_c(const nativa::string& text)
+	{
+		const char* first = find_escape<dialect::c>(text.begin(), text.end());
+		if (first == text.end()) return text;
+		return escape_from<dialect::c>(text, first);
+	}
+
+	nativa::string escape_c(const string_view& text)
+	{
+		const char* first = find_escape<dialect::c>(text.begin(), text.end());
+		if (first == text.end()) return text.clone();
+		return escape_from<dialect::c>(text, first);
+	}
+
+	void escape_c(const string_view& text, string_builder& out)
+	{
+		escape_into<dialect::c>(text, out);
+	}
+
+	ptrdiff_t unescape_c(const string_view& text, nativa::string& out)
+	{
+		return unescape<unescape_one_c>(text, nullptr, out);
+	}
+
+	ptrdiff_t unescape_c(const nativa::string& text, nativa::string& out)
+	{
+		return unescape<unescape_one_c>(text, &text, out);
+	}
+}
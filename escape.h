@@ -0,0 +1,102 @@
+#pragma once
+#ifndef NATIVA_ESCAPE
+#define NATIVA_ESCAPE
+
+#include <cstddef>
+#include "string.h"
+#include "string_builder.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Escapes text for a JSON string: the quote, the backslash and control chars below 0x20,
+	/// those without a short form as \u00XX. Other chars, UTF-8 included, are kept as they are.
+	/// </summary>
+	/// <returns>The text itself if nothing needs escaping, otherwise a string of the exact size</returns>
+	nativa::string escape_json(const nativa::string& text);
+
+	/// <summary>
+	/// Escapes text for a JSON string.
+	/// </summary>
+	/// <returns>A clone of the text if nothing needs escaping, otherwise a string of the exact size</returns>
+	nativa::string escape_json(const string_view& text);
+
+	/// <summary>
+	/// Escapes text for a JSON string, appending to a builder.
+	/// </summary>
+	void escape_json(const string_view& text, string_builder& out);
+
+	// literals are strings already, sharing them costs nothing
+	template <size_t N>
+	nativa::string escape_json(const char(&text)[N]);
+
+	/// <summary>
+	/// Unescapes the content of a JSON string, surrogate pairs given as \uXXXX\uXXXX becoming UTF-8.
+	/// Chars which are not escapes are kept as they are.
+	/// </summary>
+	/// <param name="out">Receives the text; left untouched if it is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the backslash starting the bad escape</returns>
+	ptrdiff_t unescape_json(const string_view& text, nativa::string& out);
+
+	/// <summary>
+	/// Unescapes the content of a JSON string, sharing the text if it has no escapes.
+	/// </summary>
+	/// <param name="out">Receives the text; left untouched if it is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the backslash starting the bad escape</returns>
+	ptrdiff_t unescape_json(const nativa::string& text, nativa::string& out);
+
+	/// <summary>
+	/// Escapes text for a C string literal: the quote, the backslash, the control chars and DEL,
+	/// those without a short form as 3 octal digits. Chars from 0x80 are kept as they are.
+	/// </summary>
+	/// <returns>The text itself if nothing needs escaping, otherwise a string of the exact size</returns>
+	nativa::string escape_c(const nativa::string& text);
+
+	/// <summary>
+	/// Escapes text for a C string literal.
+	/// </summary>
+	/// <returns>A clone of the text if nothing needs escaping, otherwise a string of the exact size</returns>
+	nativa::string escape_c(const string_view& text);
+
+	/// <summary>
+	/// Escapes text for a C string literal, appending to a builder.
+	/// </summary>
+	void escape_c(const string_view& text, string_builder& out);
+
+	template <size_t N>
+	nativa::string escape_c(const char(&text)[N]);
+
+	/// <summary>
+	/// Unescapes the content of a C string literal: the simple escapes,
+	/// 1 to 3 octal digits and \x with any number of hex digits, each giving one char.
+	/// </summary>
+	/// <param name="out">Receives the text; left untouched if it is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the backslash starting the bad escape,
+	/// including escapes whose value is above 0xFF</returns>
+	ptrdiff_t unescape_c(const string_view& text, nativa::string& out);
+
+	/// <summary>
+	/// Unescapes the content of a C string literal, sharing the text if it has no escapes.
+	/// </summary>
+	/// <param name="out">Receives the text; left untouched if it is invalid</param>
+	/// <returns>-1 if the text is valid, otherwise the index of the backslash starting the bad escape</returns>
+	ptrdiff_t unescape_c(const nativa::string& text, nativa::string& out);
+
+#pragma region Template Function Impl
+
+	template <size_t N>
+	inline nativa::string escape_json(const char(&text)[N])
+	{
+		return escape_json(nativa::string(text));
+	}
+
+	template <size_t N>
+	inline nativa::string escape_c(const char(&text)[N])
+	{
+		return escape_c(nativa::string(text));
+	}
+
+#pragma endregion
+}
+
+#endif
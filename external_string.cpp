@@ -0,0 +1,60 @@
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include "external_string.h"
+#include "instrumentation.h"
+
+namespace nativa
+{
+	external_header::external_header(const char* chars, size_t length, bool has_terminator, void (*release)(string_header* header))
+		: chars(chars), length(length), terminated(nullptr)
+	{
+		this->counter = 1;
+		this->flags = has_terminator ? 0u : static_cast<unsigned>(string_header::unterminated);
+		this->spare = 0;
+		this->size = 0;
+		this->release = release;
+	}
+
+	external_header::~external_header() noexcept
+	{
+		if (terminated != nullptr)
+		{
+			NATIVA_COUNT_FREE(length + 1);
+			delete[] terminated;
+		}
+	}
+
+	const char* external_header::c_str()
+	{
+		if (!(load_flags() & string_header::unterminated)) return chars;
+		std::atomic_ref<char*> copy(terminated);
+		char* res = copy.load(std::memory_order_acquire);
+		if (res == nullptr)
+		{
+			char* made = new char[length + 1];
+			NATIVA_COUNT_ALLOCATION(length + 1);
+			std::memcpy(made, chars, length);
+			made[length] = '\0';
+
+			// another thread may have made its copy meanwhile, then the one stored wins
+			if (copy.compare_exchange_strong(res, made, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				res = made;
+			}
+			else
+			{
+				NATIVA_COUNT_FREE(length + 1);
+				delete[] made;
+			}
+		}
+		return res;
+	}
+
+	bool external_header::check_terminator(const char* chars, size_t length, nul_check check)
+	{
+		if (check == nul_check::skip) return false;
+		if (chars[length] != '\0') throw std::invalid_argument("The adopted chars are not followed by a '\\0'");
+		return true;
+	}
+}
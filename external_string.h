@@ -0,0 +1,133 @@
+#pragma once
+#ifndef NATIVA_EXTERNAL_STRING
+#define NATIVA_EXTERNAL_STRING
+
+#include <cstddef>
+#include <utility>
+#include "string.h"
+#include "instrumentation.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Whether a foreign buffer is known to be followed by a '\0'.
+	/// </summary>
+	enum class nul_check
+	{
+		// the char right after the buffer is read and has to be a '\0'
+		require,
+		// nothing past the buffer is read; c_str makes a terminated copy the first time it is called
+		skip,
+	};
+
+	/// <summary>
+	/// The header of a string over foreign chars, allocated apart from them.
+	/// </summary>
+	struct external_header : string_header
+	{
+		const char* chars;
+		size_t length;
+
+		/// <summary>
+		/// The copy followed by a '\0' made by c_str for unterminated chars, nullptr until then.
+		/// </summary>
+		char* terminated;
+
+		external_header(const char* chars, size_t length, bool has_terminator, void (*release)(string_header* header));
+
+		external_header(const external_header&) = delete;
+
+		external_header& operator=(const external_header&) = delete;
+
+		~external_header() noexcept;
+
+		/// <summary>
+		/// The chars followed by a '\0', copying them the first time if they have none.
+		/// </summary>
+		const char* c_str();
+
+		/// <summary>
+		/// Checks what follows the chars as asked.
+		/// </summary>
+		/// <returns>Whether a '\0' follows the chars</returns>
+		/// <exception cref="std::invalid_argument">It is required, and missing</exception>
+		static bool check_terminator(const char* chars, size_t length, nul_check check);
+	};
+
+	/// <summary>
+	/// The header of adopted chars with the deleter giving them back.
+	/// </summary>
+	template <typename Deleter>
+	struct external_block : external_header
+	{
+		Deleter deleter;
+
+		external_block(const char* chars, size_t length, bool has_terminator, Deleter&& deleter);
+
+		static void destroy(string_header* header);
+	};
+
+	/// <summary>
+	/// Makes a string own chars allocated by someone else, such as a network or decompression library,
+	/// without copying them. The header lives in a small block of its own, and the deleter is called
+	/// with the chars and their size once the last copy of the string is gone.
+	/// If the chars are not followed by a '\0', c_str copies them the first time it is called,
+	/// so the copy is only paid for by those who need a C-style string.
+	/// </summary>
+	/// <typeparam name="Deleter">Callable as deleter(const char* chars, size_t size)</typeparam>
+	/// <param name="chars">The chars, which must not change while the string lives</param>
+	/// <param name="size">How many chars there are; the empty buffer is given back to the deleter at once</param>
+	/// <param name="deleter">How to give the chars back</param>
+	/// <param name="check">Whether to read the char after the buffer, which must then be readable</param>
+	/// <returns>The ready-to-use string</returns>
+	/// <exception cref="std::invalid_argument">A '\0' is required, and missing; the chars stay the caller's</exception>
+	/// <exception cref="std::bad_alloc">The header could not be allocated; the chars are given to the deleter first</exception>
+	template <typename Deleter>
+	nativa::string adopt_external(const char* chars, size_t size, Deleter deleter, nul_check check = nul_check::skip);
+
+#pragma region Template Function Impl
+
+	template <typename Deleter>
+	inline external_block<Deleter>::external_block(const char* chars, size_t length, bool has_terminator, Deleter&& deleter)
+		: external_header(chars, length, has_terminator, destroy), deleter(std::move(deleter))
+	{
+	}
+
+	template <typename Deleter>
+	inline void external_block<Deleter>::destroy(string_header* header)
+	{
+		auto disposed = static_cast<external_block*>(header);
+		disposed->deleter(disposed->chars, disposed->length);
+		delete disposed;
+		NATIVA_COUNT_FREE(sizeof(external_block));
+	}
+
+	template <typename Deleter>
+	inline nativa::string adopt_external(const char* chars, size_t size, Deleter deleter, nul_check check)
+	{
+		const bool has_terminator = external_header::check_terminator(chars, size, check);
+		if (size == 0)
+		{
+			deleter(chars, size);
+			return "";
+		}
+
+		external_block<Deleter>* header;
+		try
+		{
+			header = new external_block<Deleter>(chars, size, has_terminator, std::move(deleter));
+		}
+		catch (...)
+		{
+			// the deleter is only moved from once the block is allocated, and the chars are ours to give back
+			deleter(chars, size);
+			throw;
+		}
+		NATIVA_COUNT_ALLOCATION(sizeof(external_block<Deleter>));
+		return string_internals::adopt(header, chars, chars + size);
+	}
+
+#pragma endregion
+}
+
+#endif
@@ -15,6 +15,8 @@ namespace nativa
 		template <typename... Args>
 		friend nativa::string format(const string_view& fmt, Args... args);
 
+		friend class formatted_message;
+
 		struct format_guide
 		{
 			size_t target;
@@ -32,6 +34,12 @@ namespace nativa
 		std::vector<nativa::string_view> res;
 		std::vector<std::vector<format_guide>> guides;
 
+		/// <summary>
+		/// Parses the format and fills in the args, leaving the segments in res.
+		/// </summary>
+		template <typename... Args>
+		void build(const string_view& fmt, Args... args);
+
 		void parse(const string_view& fmt);
 
 		template <typename T>
@@ -52,13 +60,19 @@ namespace nativa
 	{
 		format_internal context;
 
-		context.guides.resize(format_internal::count_args(args...));
+		context.build(fmt, args...);
 
-		context.parse(fmt);
+		return string::concat(context.res);
+	}
 
-		context.fill(0, args...);
+	template <typename... Args>
+	inline void format_internal::build(const string_view& fmt, Args... args)
+	{
+		guides.resize(count_args(args...));
 
-		return string::concat(context.res);
+		parse(fmt);
+
+		fill(0, args...);
 	}
 
 	template <typename First, typename ...Args>
@@ -0,0 +1,102 @@
+#include <cerrno>
+#include <system_error>
+#include "format_io.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NATIVA_HAS_WRITEV 1
+#include <climits>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+namespace nativa
+{
+	namespace
+	{
+		[[noreturn]] void throw_errno(const char* what)
+		{
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+
+#ifdef NATIVA_HAS_WRITEV
+#ifdef IOV_MAX
+		const size_t max_iov = IOV_MAX;
+#else
+		const size_t max_iov = 1024;
+#endif
+#endif
+	}
+
+	void formatted_message::collect()
+	{
+		m_iov.reserve(m_context.res.size());
+		for (const auto& segment : m_context.res)
+		{
+			if (segment.is_empty()) continue;
+			m_iov.push_back(iovec{ const_cast<char*>(segment.begin()), segment.size() });
+			m_size += segment.size();
+		}
+	}
+
+	const iovec* formatted_message::iov() const
+	{
+		return m_iov.data();
+	}
+
+	size_t formatted_message::iov_count() const
+	{
+		return m_iov.size();
+	}
+
+	size_t formatted_message::size() const
+	{
+		return m_size;
+	}
+
+	nativa::string formatted_message::to_string() const
+	{
+		return string::concat(m_context.res);
+	}
+
+	void write_formatted(int fd, const formatted_message& message)
+	{
+		const iovec* iov = message.iov();
+		size_t count = message.iov_count();
+
+		// copied only after a partial write, which leaves a segment half written
+		std::vector<iovec> pending;
+		while (count != 0)
+		{
+#ifdef NATIVA_HAS_WRITEV
+			const ssize_t written = ::writev(fd, iov, static_cast<int>(count < max_iov ? count : max_iov));
+#else
+			const auto written = ::_write(fd, iov->iov_base, static_cast<unsigned>(iov->iov_len));
+#endif
+			if (written < 0)
+			{
+				if (errno == EINTR) continue;
+				throw_errno("write_formatted");
+			}
+
+			size_t left = static_cast<size_t>(written);
+			while (count != 0 && left >= iov->iov_len)
+			{
+				left -= iov->iov_len;
+				++iov;
+				--count;
+			}
+			if (left != 0)
+			{
+				if (pending.empty())
+				{
+					pending.assign(iov, iov + count);
+					iov = pending.data();
+				}
+				iovec& first = pending[static_cast<size_t>(iov - pending.data())];
+				first.iov_base = static_cast<char*>(first.iov_base) + left;
+				first.iov_len -= left;
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef NATIVA_FORMAT_IO
+#define NATIVA_FORMAT_IO
+
+#include <cstddef>
+#include <vector>
+#include "format.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#else
+// the same layout as the POSIX one, for the platforms lacking it
+struct iovec
+{
+	void* iov_base;
+	size_t iov_len;
+};
+#endif
+
+namespace nativa
+{
+	/// <summary>
+	/// The result of nativa::format before the segments are concatenated:
+	/// the parts of the format and the converted args as an iovec array, ready for writev.
+	/// Holds the strings the args were converted to, so the segments stay valid
+	/// as long as it lives; args passed as string_views or char pointers are
+	/// referred to, not copied, and must outlive it too.
+	/// </summary>
+	class formatted_message
+	{
+	public:
+		template <typename... Args>
+		formatted_message(const string_view& fmt, Args... args);
+
+		/// <summary>
+		/// The non-empty segments in order.
+		/// </summary>
+		const iovec* iov() const;
+
+		size_t iov_count() const;
+
+		/// <summary>
+		/// The total size of the segments in bytes.
+		/// </summary>
+		size_t size() const;
+
+		/// <summary>
+		/// Concatenates the segments, which is what nativa::format returns.
+		/// </summary>
+		nativa::string to_string() const;
+
+	private:
+		format_internal m_context;
+
+		std::vector<iovec> m_iov;
+
+		size_t m_size;
+
+		void collect();
+	};
+
+	/// <summary>
+	/// Same as nativa::format, but leaves the segments unconcatenated.
+	/// </summary>
+	template <typename... Args>
+	formatted_message format_iov(const string_view& fmt, Args... args);
+
+	/// <summary>
+	/// Writes all the segments to a file descriptor with as few writev calls as possible,
+	/// retrying after partial writes and interruptions.
+	/// Throws std::system_error if the write fails.
+	/// </summary>
+	/// <param name="fd">An open file descriptor, blocking</param>
+	/// <param name="message">The segments</param>
+	void write_formatted(int fd, const formatted_message& message);
+
+	/// <summary>
+	/// Formats and writes to a file descriptor without concatenating the segments.
+	/// </summary>
+	template <typename... Args>
+	void write_formatted(int fd, const string_view& fmt, Args... args);
+
+#pragma region Template Function Impl
+
+	template <typename... Args>
+	inline formatted_message::formatted_message(const string_view& fmt, Args... args)
+		: m_size(0)
+	{
+		m_context.build(fmt, args...);
+		collect();
+	}
+
+	template <typename... Args>
+	inline formatted_message format_iov(const string_view& fmt, Args... args)
+	{
+		return formatted_message(fmt, args...);
+	}
+
+	template <typename... Args>
+	inline void write_formatted(int fd, const string_view& fmt, Args... args)
+	{
+		write_formatted(fd, formatted_message(fmt, args...));
+	}
+
+#pragma endregion
+}
+
+#endif
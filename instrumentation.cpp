@@ -0,0 +1,58 @@
+#include "instrumentation.h"
+
+namespace nativa
+{
+	namespace instrumentation
+	{
+		counters counters::operator-(const counters& earlier) const
+		{
+			counters res;
+			res.allocations = allocations - earlier.allocations;
+			res.frees = frees - earlier.frees;
+			res.allocated_bytes = allocated_bytes - earlier.allocated_bytes;
+			res.live_bytes = live_bytes - earlier.live_bytes;
+			res.peak_bytes = peak_bytes;
+			res.ref_increments = ref_increments - earlier.ref_increments;
+			res.ref_decrements = ref_decrements - earlier.ref_decrements;
+			res.copies = copies - earlier.copies;
+			res.moves = moves - earlier.moves;
+			res.clones = clones - earlier.clones;
+			res.builder_regrowths = builder_regrowths - earlier.builder_regrowths;
+			return res;
+		}
+
+#ifdef NATIVA_INSTRUMENTATION
+		counters& local()
+		{
+			thread_local counters current{};
+			return current;
+		}
+
+		void count_allocation(size_t bytes)
+		{
+			counters& current = local();
+			current.allocations += 1;
+			current.allocated_bytes += bytes;
+			current.live_bytes += static_cast<ptrdiff_t>(bytes);
+			if (current.live_bytes > current.peak_bytes) current.peak_bytes = current.live_bytes;
+		}
+
+		void count_free(size_t bytes)
+		{
+			counters& current = local();
+			current.frees += 1;
+			current.live_bytes -= static_cast<ptrdiff_t>(bytes);
+		}
+
+		counters snapshot()
+		{
+			return local();
+		}
+#else
+		counters snapshot()
+		{
+			return counters{};
+		}
+#endif
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef NATIVA_INSTRUMENTATION_COUNTERS
+#define NATIVA_INSTRUMENTATION_COUNTERS
+
+#include <cstddef>
+
+// Define NATIVA_INSTRUMENTATION (the CMake option of the same name does)
+// to count what the strings do on each thread. Otherwise the counting
+// compiles to nothing and snapshot() always returns zeros.
+
+namespace nativa
+{
+	namespace instrumentation
+	{
+		/// <summary>
+		/// What the strings have done on one thread.
+		/// Memory freed on another thread than the one allocating it is counted
+		/// where it is freed, so the live bytes of a thread may go below zero.
+		/// </summary>
+		struct counters
+		{
+			// buffers made by string_internals::alloc, and those of them freed
+			size_t allocations;
+			size_t frees;
+			size_t allocated_bytes;
+			ptrdiff_t live_bytes;
+			ptrdiff_t peak_bytes;
+
+			size_t ref_increments;
+			size_t ref_decrements;
+
+			// copies and moves of nativa::string, whether ref-counted or not
+			size_t copies;
+			size_t moves;
+
+			size_t clones;
+
+			// reallocations of a string_builder's buffer, or of a string appended to
+			size_t builder_regrowths;
+
+			/// <summary>
+			/// The counts happened between two snapshots.
+			/// peak_bytes is kept from the later one, a peak being no count.
+			/// </summary>
+			counters operator-(const counters& earlier) const;
+		};
+
+		/// <summary>
+		/// Copies the counters of the calling thread.
+		/// </summary>
+		counters snapshot();
+
+#ifdef NATIVA_INSTRUMENTATION
+		counters& local();
+
+		void count_allocation(size_t bytes);
+
+		void count_free(size_t bytes);
+#endif
+	}
+}
+
+#ifdef NATIVA_INSTRUMENTATION
+#define NATIVA_COUNT(counter) (++::nativa::instrumentation::local().counter)
+#define NATIVA_COUNT_ALLOCATION(bytes) (::nativa::instrumentation::count_allocation(bytes))
+#define NATIVA_COUNT_FREE(bytes) (::nativa::instrumentation::count_free(bytes))
+#else
+#define NATIVA_COUNT(counter) ((void)0)
+#define NATIVA_COUNT_ALLOCATION(bytes) ((void)0)
+#define NATIVA_COUNT_FREE(bytes) ((void)0)
+#endif
+
+#endif
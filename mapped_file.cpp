@@ -0,0 +1,151 @@
+#include <cerrno>
+#include <system_error>
+#include "mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NATIVA_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <cstdio>
+#endif
+
+namespace nativa
+{
+	namespace
+	{
+		[[noreturn]] void throw_errno(const char* what)
+		{
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+	}
+
+#ifdef NATIVA_HAS_MMAP
+	namespace
+	{
+		struct mapped_header : string_header
+		{
+			void* address;
+			size_t length;
+		};
+
+		void release_mapping(string_header* header)
+		{
+			auto mapped = static_cast<mapped_header*>(header);
+			::munmap(mapped->address, mapped->length);
+			delete mapped;
+		}
+
+		struct file_closer
+		{
+			int fd;
+
+			~file_closer()
+			{
+				::close(fd);
+			}
+		};
+
+		void advise(void* address, size_t length, map_advice advice)
+		{
+			// only hints, failing to follow them changes nothing but the speed
+#ifdef MADV_SEQUENTIAL
+			if (advice & map_advice::sequential) ::madvise(address, length, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+			if (advice & map_advice::will_need) ::madvise(address, length, MADV_WILLNEED);
+#endif
+#ifdef MADV_HUGEPAGE
+			if (advice & map_advice::huge_pages) ::madvise(address, length, MADV_HUGEPAGE);
+#endif
+		}
+	}
+
+	nativa::string map_file(const nativa::string& path, map_advice advice)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1) throw_errno("open");
+		file_closer closer{ fd };
+
+		struct stat info;
+		if (::fstat(fd, &info) == -1) throw_errno("fstat");
+
+		const size_t size = static_cast<size_t>(info.st_size);
+		if (size == 0) return "";
+
+		// The memory looks like:
+		// [ file ... ] [ zeros to the end of the page ] ( [ a whole zero page ] )
+		// The kernel zeros the rest of the last page, but a file ending right
+		// at a page boundary needs one more page for the '\0'. So an anonymous
+		// region large enough is reserved first and the file mapped over it.
+		const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		const size_t length = (size + 1 + page - 1) / page * page;
+
+		// allocated before mapping, so that nothing may throw once the mapping exists
+		auto header = new mapped_header();
+
+		void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (address == MAP_FAILED)
+		{
+			int error = errno;
+			delete header;
+			errno = error;
+			throw_errno("mmap");
+		}
+
+		if (::mmap(address, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+		{
+			int error = errno;
+			::munmap(address, length);
+			delete header;
+			errno = error;
+			throw_errno("mmap");
+		}
+
+		advise(address, size, advice);
+
+		header->counter = 1;
+		header->flags = 0;
+		header->release = release_mapping;
+		header->address = address;
+		header->length = length;
+
+		const char* begin = static_cast<const char*>(address);
+		return string_internals::adopt(header, begin, begin + size);
+	}
+#else
+	nativa::string map_file(const nativa::string& path, map_advice)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr) throw_errno("fopen");
+
+		std::fseek(file, 0, SEEK_END);
+		long size = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+		if (size <= 0)
+		{
+			std::fclose(file);
+			if (size < 0) throw_errno("ftell");
+			return "";
+		}
+
+		char* buffer;
+		auto res = string_internals::alloc(static_cast<size_t>(size), buffer);
+		size_t read = std::fread(buffer, 1, static_cast<size_t>(size), file);
+		const bool failed = std::ferror(file) != 0;
+		int error = errno;
+		std::fclose(file);
+		if (read != static_cast<size_t>(size))
+		{
+			// errno only tells something when the stream has an error; without one the file got shorter
+			if (!failed) throw std::system_error(std::make_error_code(std::errc::io_error), "fread: the file shrank while being read");
+			errno = error != 0 ? error : EIO;
+			throw_errno("fread");
+		}
+
+		return res;
+	}
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef NATIVA_MAPPED_FILE
+#define NATIVA_MAPPED_FILE
+
+#include "string.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Hints about how a mapped file is going to be read.
+	/// Combine them with |. Hints the system does not support are ignored.
+	/// </summary>
+	enum class map_advice : unsigned
+	{
+		none = 0,
+		// will be read from the beginning to the end, so read ahead aggressively
+		sequential = 1,
+		// will be read soon, so start paging it in now
+		will_need = 2,
+		// back the mapping with huge pages where the file system allows it
+		huge_pages = 4,
+	};
+
+	constexpr map_advice operator|(map_advice left, map_advice right)
+	{
+		return static_cast<map_advice>(static_cast<unsigned>(left) | static_cast<unsigned>(right));
+	}
+
+	constexpr bool operator&(map_advice left, map_advice right)
+	{
+		return (static_cast<unsigned>(left) & static_cast<unsigned>(right)) != 0;
+	}
+
+	/// <summary>
+	/// Maps a whole file read-only into memory as a runtime string.
+	/// The chars are the page cache itself: nothing is copied, and slices or splits
+	/// of the string read the file directly. The file is unmapped when the last
+	/// copy of the string is gone. Later changes to the file must be avoided
+	/// as the string is supposed to be immutable.
+	/// Where mapping is not available the file is read into a newly allocated string.
+	/// </summary>
+	/// <param name="path">Path of the file</param>
+	/// <param name="advice">How the string is going to be read</param>
+	/// <returns>The content of the file, "" if it is empty</returns>
+	/// <exception cref="std::system_error">The file cannot be opened or mapped</exception>
+	nativa::string map_file(const nativa::string& path, map_advice advice = map_advice::none);
+}
+
+#endif
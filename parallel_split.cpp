@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <iterator>
+#include "parallel_split.h"
+#include "chunking.h"
+
+namespace nativa
+{
+	namespace
+	{
+		/// <summary>
+		/// The delimiters found in each chunk, and where each chunk's go in the whole.
+		/// </summary>
+		struct chunked_delims
+		{
+			std::vector<std::vector<size_t>> found;
+			std::vector<size_t> first_index;
+			size_t total;
+		};
+
+		chunked_delims find_chunked(const string_view& str, char delim, size_t chunks)
+		{
+			chunked_delims res;
+			res.found.resize(chunks);
+			res.first_index.resize(chunks);
+
+			const size_t size = str.size();
+			chunking::run_chunks(chunks, [&](size_t chunk)
+			{
+				// a delimiter is a single char, so it never straddles two chunks
+				const size_t begin = size * chunk / chunks;
+				const size_t end = size * (chunk + 1) / chunks;
+				const auto part = str.slice(begin, end - begin);
+
+				auto& found = res.found[chunk];
+				ptrdiff_t at = part.index_of(delim);
+				while (at != -1)
+				{
+					found.push_back(begin + at);
+					at = part.index_of(delim, at + 1);
+				}
+			});
+
+			res.total = 0;
+			for (size_t i = 0; i < chunks; ++i)
+			{
+				res.first_index[i] = res.total;
+				res.total += res.found[i].size();
+			}
+			return res;
+		}
+	}
+
+	std::vector<nativa::string_view> parallel_split(const string_view& str, char delim, size_t threads)
+	{
+		const size_t chunks = chunking::chunk_count(str.size(), threads);
+		if (chunks == 1)
+		{
+			std::vector<nativa::string_view> res;
+			str.split(delim, std::back_inserter(res));
+			return res;
+		}
+
+		auto delims = find_chunked(str, delim, chunks);
+		const char* base = str.begin();
+
+		// where the first slice ending in each chunk begins, found by walking the chunks once
+		std::vector<const char*> first_begin(chunks);
+		const char* last_begin = base;
+		for (size_t i = 0; i < chunks; ++i)
+		{
+			first_begin[i] = last_begin;
+			if (!delims.found[i].empty()) last_begin = base + delims.found[i].back() + 1;
+		}
+
+		// slice i ends at delimiter i, the extra last one ends at the end
+		std::vector<nativa::string_view> res(delims.total + 1);
+		chunking::run_chunks(chunks, [&](size_t chunk)
+		{
+			const char* begin = first_begin[chunk];
+			size_t index = delims.first_index[chunk];
+			for (size_t at : delims.found[chunk])
+			{
+				res[index] = nativa::string_view(begin, base + at);
+				begin = base + at + 1;
+				++index;
+			}
+		});
+		res[delims.total] = nativa::string_view(last_begin, str.end());
+
+		return res;
+	}
+
+	std::vector<size_t> parallel_find_all(const string_view& str, char delim, size_t threads)
+	{
+		const size_t chunks = chunking::chunk_count(str.size(), threads);
+		auto delims = find_chunked(str, delim, chunks);
+		if (chunks == 1) return std::move(delims.found[0]);
+
+		std::vector<size_t> res(delims.total);
+		chunking::run_chunks(chunks, [&](size_t chunk)
+		{
+			const auto& found = delims.found[chunk];
+			std::copy(found.begin(), found.end(), res.begin() + delims.first_index[chunk]);
+		});
+		return res;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef NATIVA_PARALLEL_SPLIT
+#define NATIVA_PARALLEL_SPLIT
+
+#include <cstddef>
+#include <vector>
+#include "string_view.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Splits the string_view into slices by the given delimiter like string_view::split,
+	/// scanning equal chunks of it on several threads.
+	/// Inputs too small to be worth a thread are split on the calling one.
+	/// </summary>
+	/// <param name="str">The string_view to split</param>
+	/// <param name="delim">The delimiter char</param>
+	/// <param name="threads">How many threads may be used, 0 for one per hardware thread</param>
+	/// <returns>The slices in order</returns>
+	std::vector<nativa::string_view> parallel_split(const string_view& str, char delim, size_t threads = 0);
+
+	/// <summary>
+	/// Same as parallel_split, but only gives the indices of the delimiters,
+	/// which takes half the memory of the slices.
+	/// Slice i spans from the delimiter i - 1 (or the beginning) to the delimiter i (or the end).
+	/// </summary>
+	/// <returns>The indices of the delimiters in ascending order</returns>
+	std::vector<size_t> parallel_find_all(const string_view& str, char delim, size_t threads = 0);
+}
+
+#endif
@@ -0,0 +1,434 @@
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "parse_column.h"
+#include "simd.h"
+#include "chunking.h"
+
+namespace nativa
+{
+	namespace
+	{
+		inline bool is_digit(char c)
+		{
+			return static_cast<unsigned char>(c - '0') < 10;
+		}
+
+		inline const char* find_delim(const char* at, const char* end, char delim)
+		{
+			auto res = std::memchr(at, delim, end - at);
+			return res == nullptr ? end : static_cast<const char*>(res);
+		}
+
+		size_t count_char(const char* it, const char* end, char c)
+		{
+			size_t res = 0;
+#ifdef NATIVA_SIMD_SSE2
+			const __m128i target = _mm_set1_epi8(c);
+			for (; end - it >= 16; it += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+				res += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, target))));
+			}
+#endif
+			for (; it != end; ++it) res += *it == c;
+			return res;
+		}
+
+		/// <summary>
+		/// How many digits lead the text, looked for 16 chars a time,
+		/// which also finds where the field ends in the common case.
+		/// </summary>
+		inline size_t digit_run(const char* at, const char* end)
+		{
+			const char* it = at;
+#ifdef NATIVA_SIMD_SSE2
+			for (; end - it >= 16; it += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+				// the chars from 0x80 are negative, so below '0' as well
+				const __m128i digits = _mm_and_si128(
+					_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)),
+					_mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)));
+				const uint32_t others = ~static_cast<uint32_t>(_mm_movemask_epi8(digits)) & 0xFFFF;
+				if (others != 0) return it - at + simd::lowest_bit(others);
+			}
+#endif
+			while (it != end && is_digit(*it)) ++it;
+			return it - at;
+		}
+
+		/// <summary>
+		/// The value of 1 to 8 digits, converted all at once in a word
+		/// with three multiplications when the machine is little endian.
+		/// </summary>
+		inline uint64_t eight_digits(const char* at, size_t count, const char* end)
+		{
+			if constexpr (std::endian::native == std::endian::little)
+			{
+				uint64_t word = 0;
+				std::memcpy(&word, at, end - at >= 8 ? 8 : static_cast<size_t>(end - at));
+				// the chars after the digits are shifted out, and the zeros shifted in are leading zeros
+				word = (word - 0x3030303030303030ull) << (8 * (8 - count));
+				word = word * 10 + (word >> 8);
+				return ((word & 0x000000FF000000FFull) * (100 + (1000000ull << 32))
+					+ ((word >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))) >> 32;
+			}
+			else
+			{
+				uint64_t res = 0;
+				for (size_t i = 0; i < count; ++i) res = res * 10 + (at[i] - '0');
+				return res;
+			}
+		}
+
+#ifdef NATIVA_SIMD_SSSE3
+		/// <summary>
+		/// The value of 1 to 16 digits with 16 chars readable, without a branch on the count:
+		/// the digits are shuffled to the right of a vector, then summed up pairwise.
+		/// </summary>
+		inline uint64_t sixteen_digits(const char* at, size_t count)
+		{
+			const __m128i chunk = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(at)), _mm_set1_epi8('0'));
+			// the lanes before the digits get indices with the top bit set, which pshufb zeroes
+			const __m128i indices = _mm_add_epi8(
+				_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+				_mm_set1_epi8(static_cast<char>(count - 16)));
+			const __m128i digits = _mm_shuffle_epi8(chunk, indices);
+			const __m128i pairs = _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+			const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+			const __m128i packed = _mm_packs_epi32(quads, quads);
+			const __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+			const uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+			const uint64_t low = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
+			return high * 100000000 + low;
+		}
+#endif
+
+		/// <summary>
+		/// The value of 1 to 19 digits, which always fits.
+		/// </summary>
+		inline uint64_t digits_value(const char* at, size_t count, const char* end)
+		{
+#ifdef NATIVA_SIMD_SSSE3
+			if (count <= 16 && end - at >= 16) return sixteen_digits(at, count);
+#endif
+			if (count <= 8) return eight_digits(at, count, end);
+			if (count <= 16) return eight_digits(at, count - 8, end) * 100000000 + eight_digits(at + count - 8, 8, end);
+			return eight_digits(at, count - 16, end) * 10000000000000000ull
+				+ eight_digits(at + count - 16, 8, end) * 100000000
+				+ eight_digits(at + count - 8, 8, end);
+		}
+
+		/// <summary>
+		/// Parses the integer field beginning at the text.
+		/// </summary>
+		/// <returns>Where the field ends, at a delimiter or the end</returns>
+		template <typename T>
+		const char* parse_integer(const char* at, const char* end, char delim, T& value, parse_error& error)
+		{
+			const char* const field = at;
+			value = 0;
+			bool negative = false;
+			if (at != end && (*at == '-' || *at == '+'))
+			{
+				negative = *at == '-';
+				++at;
+			}
+
+			const size_t count = digit_run(at, end);
+			const char* const stop = at + count;
+			if (stop != end && *stop != delim)
+			{
+				error = parse_error::invalid;
+				return find_delim(stop, end, delim);
+			}
+			if (count == 0)
+			{
+				error = stop == field ? parse_error::empty : parse_error::invalid;
+				return stop;
+			}
+			if (negative && std::is_unsigned_v<T>)
+			{
+				error = parse_error::invalid;
+				return stop;
+			}
+
+			uint64_t magnitude;
+			if (count <= 19)
+			{
+				magnitude = digits_value(at, count, end);
+			}
+			else
+			{
+				// past 19 digits only leading zeros keep it in range
+				while (stop - at > 19 && *at == '0') ++at;
+				const size_t left = stop - at;
+				magnitude = left <= 19 ? digits_value(at, left, end) : 0;
+				if (left == 20)
+				{
+					const uint64_t head = digits_value(at, 19, end);
+					const uint64_t last = stop[-1] - '0';
+					if (head > (std::numeric_limits<uint64_t>::max() - last) / 10)
+					{
+						error = parse_error::overflow;
+						return stop;
+					}
+					magnitude = head * 10 + last;
+				}
+				else if (left > 20)
+				{
+					error = parse_error::overflow;
+					return stop;
+				}
+			}
+
+			const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+			if (magnitude > limit)
+			{
+				error = parse_error::overflow;
+				return stop;
+			}
+			// wraps into the most negative value as well
+			value = static_cast<T>(negative ? 0 - magnitude : magnitude);
+			error = parse_error::none;
+			return stop;
+		}
+
+		/// <summary>
+		/// The powers of ten a float type holds exactly, and the mantissas it holds exactly,
+		/// a product or quotient of which is rounded only once.
+		/// </summary>
+		template <typename T>
+		struct exact_float;
+
+		template <>
+		struct exact_float<double>
+		{
+			static constexpr int max_exponent = 22;
+			static constexpr uint64_t max_mantissa = uint64_t(1) << 53;
+			static constexpr double powers[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		};
+
+		template <>
+		struct exact_float<float>
+		{
+			static constexpr int max_exponent = 10;
+			static constexpr uint64_t max_mantissa = uint64_t(1) << 24;
+			static constexpr float powers[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+		};
+
+		const uint64_t integer_powers[] = {
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+			1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+			100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+			1000000000000000000ull, 10000000000000000000ull };
+
+		template <typename T>
+		const char* parse_float_slowly(const char* field, const char* stop, T& value, parse_error& error)
+		{
+			value = 0;
+			if (field == stop)
+			{
+				error = parse_error::empty;
+				return stop;
+			}
+
+			// std::from_chars takes no plus sign
+			const char* first = field;
+			if (*first == '+' && stop - first > 1 && first[1] != '-') ++first;
+			T res;
+			const auto parsed = std::from_chars(first, stop, res);
+			if (parsed.ec == std::errc::result_out_of_range) error = parse_error::overflow;
+			else if (parsed.ec != std::errc() || parsed.ptr != stop) error = parse_error::invalid;
+			else
+			{
+				value = res;
+				error = parse_error::none;
+			}
+			return stop;
+		}
+
+		/// <summary>
+		/// Parses the floating point field beginning at the text.
+		/// </summary>
+		/// <returns>Where the field ends, at a delimiter or the end</returns>
+		template <typename T>
+		const char* parse_float(const char* at, const char* end, char delim, T& value, parse_error& error)
+		{
+			const char* const field = at;
+			bool negative = false;
+			if (at != end && (*at == '-' || *at == '+'))
+			{
+				negative = *at == '-';
+				++at;
+			}
+
+			const char* const integral = at;
+			const size_t integral_count = digit_run(at, end);
+			at += integral_count;
+			const char* fraction = at;
+			size_t fraction_count = 0;
+			if (at != end && *at == '.')
+			{
+				fraction = at + 1;
+				fraction_count = digit_run(fraction, end);
+				at = fraction + fraction_count;
+			}
+			const size_t digit_count = integral_count + fraction_count;
+
+			int64_t exponent = 0;
+			bool exponent_valid = true;
+			if (digit_count != 0 && at != end && (*at == 'e' || *at == 'E'))
+			{
+				++at;
+				bool exponent_negative = false;
+				if (at != end && (*at == '-' || *at == '+'))
+				{
+					exponent_negative = *at == '-';
+					++at;
+				}
+				const size_t exponent_count = digit_run(at, end);
+				exponent_valid = exponent_count != 0;
+				for (size_t i = 0; i < exponent_count; ++i)
+				{
+					// far past any float range already
+					if (exponent < 100000) exponent = exponent * 10 + (at[i] - '0');
+				}
+				if (exponent_negative) exponent = -exponent;
+				at += exponent_count;
+			}
+
+			if (digit_count != 0 && digit_count <= 19 && exponent_valid && (at == end || *at == delim))
+			{
+				uint64_t mantissa = integral_count != 0 ? digits_value(integral, integral_count, end) : 0;
+				if (fraction_count != 0)
+				{
+					mantissa = mantissa * integer_powers[fraction_count] + digits_value(fraction, fraction_count, end);
+				}
+				const int64_t scale = exponent - static_cast<int64_t>(fraction_count);
+				using exact = exact_float<T>;
+				if (mantissa <= exact::max_mantissa && scale >= -exact::max_exponent && scale <= exact::max_exponent)
+				{
+					T res = static_cast<T>(mantissa);
+					res = scale < 0 ? res / exact::powers[-scale] : res * exact::powers[scale];
+					value = negative ? -res : res;
+					error = parse_error::none;
+					return at;
+				}
+			}
+
+			// long mantissas, large exponents, infinities and whatever is not a number
+			return parse_float_slowly(field, find_delim(at, end, delim), value, error);
+		}
+
+		template <typename T>
+		column_parse_result parse_range(const char* at, const char* end, char delim, T* out, size_t capacity, parse_error* errors)
+		{
+			column_parse_result res = { 0, 0 };
+			while (at != end && res.count < capacity)
+			{
+				parse_error error;
+				const char* stop;
+				if constexpr (std::is_floating_point_v<T>) stop = parse_float(at, end, delim, out[res.count], error);
+				else stop = parse_integer(at, end, delim, out[res.count], error);
+
+				if (errors != nullptr) errors[res.count] = error;
+				if (error != parse_error::none) ++res.errors;
+				++res.count;
+
+				if (stop == end) break;
+				at = stop + 1;
+			}
+			return res;
+		}
+
+		template <typename T>
+		column_parse_result parse_column_of(const string_view& text, char delim, T* out, size_t capacity, parse_error* errors, size_t threads)
+		{
+			const size_t chunks = chunking::chunk_count(text.size(), threads);
+			if (chunks == 1) return parse_range(text.begin(), text.end(), delim, out, capacity, errors);
+
+			// every chunk begins right after a delimiter
+			const char* const begin = text.begin();
+			const char* const end = text.end();
+			std::vector<const char*> cuts(chunks + 1);
+			cuts[0] = begin;
+			cuts[chunks] = end;
+			for (size_t i = 1; i < chunks; ++i)
+			{
+				const char* at = begin + text.size() * i / chunks;
+				if (at < cuts[i - 1]) at = cuts[i - 1];
+				const char* found = find_delim(at, end, delim);
+				cuts[i] = found == end ? end : found + 1;
+			}
+
+			// the fields of each chunk are counted first to know where its values go
+			std::vector<size_t> firsts(chunks + 1);
+			chunking::run_chunks(chunks, [&](size_t chunk)
+			{
+				firsts[chunk + 1] = count_char(cuts[chunk], cuts[chunk + 1], delim);
+			});
+			if (begin != end && end[-1] != delim) firsts[chunks] += 1;
+			for (size_t i = 0; i < chunks; ++i) firsts[i + 1] += firsts[i];
+
+			std::vector<column_parse_result> results(chunks, column_parse_result{ 0, 0 });
+			chunking::run_chunks(chunks, [&](size_t chunk)
+			{
+				const size_t first = firsts[chunk];
+				if (first >= capacity) return;
+				results[chunk] = parse_range(cuts[chunk], cuts[chunk + 1], delim,
+					out + first, capacity - first, errors != nullptr ? errors + first : nullptr);
+			});
+
+			column_parse_result res = { 0, 0 };
+			for (const auto& result : results)
+			{
+				res.count += result.count;
+				res.errors += result.errors;
+			}
+			return res;
+		}
+	}
+
+	size_t column_size(const string_view& text, char delim)
+	{
+		if (text.is_empty()) return 0;
+		return count_char(text.begin(), text.end(), delim) + (text.end()[-1] != delim ? 1 : 0);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, int32_t* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, int64_t* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, uint32_t* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, uint64_t* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, float* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+
+	column_parse_result parse_column(const string_view& text, char delim, double* out, size_t capacity, parse_error* errors, size_t threads)
+	{
+		return parse_column_of(text, delim, out, capacity, errors, threads);
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef NATIVA_PARSE_COLUMN
+#define NATIVA_PARSE_COLUMN
+
+#include <cstddef>
+#include <cstdint>
+#include "string_view.h"
+
+namespace nativa
+{
+	enum class parse_error : unsigned char
+	{
+		none,
+		// nothing between two delimiters
+		empty,
+		// not a number, or followed by something other than the delimiter
+		invalid,
+		// a number too large for the type
+		overflow,
+	};
+
+	struct column_parse_result
+	{
+		// how many values were written
+		size_t count;
+		// how many of them are in error, and were written as 0
+		size_t errors;
+	};
+
+	/// <summary>
+	/// The number of fields of a column: one per delimiter, and one more
+	/// if the text does not end with a delimiter. The empty text has none.
+	/// </summary>
+	size_t column_size(const string_view& text, char delim);
+
+	/// <summary>
+	/// Parses a column of decimal integers separated by a delimiter into a caller array,
+	/// finding the end of each number and converting its digits in the same step,
+	/// 16 chars at a time. A sign may lead, a '-' only for the signed types;
+	/// nothing else, not even spaces, may be around the digits.
+	/// </summary>
+	/// <param name="text">The fields, the last of which needs no delimiter after it</param>
+	/// <param name="delim">The char between fields, such as ',' or '\n'</param>
+	/// <param name="out">The array receiving the values</param>
+	/// <param name="capacity">The size of the array; the fields past it are left alone, see column_size</param>
+	/// <param name="errors">nullptr, or an array as large as out receiving what went wrong with each field</param>
+	/// <param name="threads">How many threads may be used, 0 for one per hardware thread;
+	/// the text is cut at delimiters into chunks of at least a megabyte</param>
+	column_parse_result parse_column(const string_view& text, char delim, int32_t* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+
+	column_parse_result parse_column(const string_view& text, char delim, int64_t* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+
+	column_parse_result parse_column(const string_view& text, char delim, uint32_t* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+
+	column_parse_result parse_column(const string_view& text, char delim, uint64_t* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+
+	/// <summary>
+	/// Same as the integer ones, but parses decimal floating point numbers, with an optional
+	/// fraction and exponent. Those with up to 19 significant digits and a small exponent
+	/// are converted exactly from their digits; the rest go through std::from_chars.
+	/// </summary>
+	column_parse_result parse_column(const string_view& text, char delim, float* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+
+	column_parse_result parse_column(const string_view& text, char delim, double* out, size_t capacity, parse_error* errors = nullptr, size_t threads = 1);
+}
+
+#endif
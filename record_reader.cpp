@@ -0,0 +1,161 @@
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include "record_reader.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace nativa
+{
+	/// <summary>
+	/// A buffer, together with the header shared by the strings promoted from it.
+	/// The reader owns one reference to its current block.
+	/// </summary>
+	struct record_reader::block : string_header
+	{
+		size_t capacity;
+
+		char* data()
+		{
+			return reinterpret_cast<char*>(this + 1);
+		}
+
+		static block* create(size_t capacity)
+		{
+			// The memory looks like:
+			// [ block ] [ capacity chars ] [ a spare char for the '\0' of a promoted last record ]
+			char* memory = new char[sizeof(block) + capacity + 1];
+			block* res = new (memory) block();
+			res->counter = 1;
+			res->flags = string_header::shared;
+			res->release = destroy;
+			res->capacity = capacity;
+			return res;
+		}
+
+		static void destroy(string_header* header)
+		{
+			block* disposed = static_cast<block*>(header);
+			disposed->~block();
+			delete[] reinterpret_cast<char*>(disposed);
+		}
+
+		static void drop(block* dropped)
+		{
+			dropped->counter -= 1;
+			if (dropped->counter == 0) destroy(dropped);
+		}
+	};
+
+	record_reader::record_reader(int fd, char delim, size_t buffer_size)
+		: m_fd(fd), m_delim(delim), m_block(block::create(buffer_size)), m_eof(false)
+	{
+		assert(buffer_size > 0);
+
+		m_filled = m_block->data();
+		m_pos = m_filled;
+		m_scanned = m_filled;
+	}
+
+	record_reader::~record_reader() noexcept
+	{
+		block::drop(m_block);
+	}
+
+	bool record_reader::next(nativa::string_view& record)
+	{
+		for (;;)
+		{
+			ptrdiff_t found = string_view(m_scanned, m_filled).index_of(m_delim);
+			if (found != -1)
+			{
+				const char* end = m_scanned + found;
+				m_record = string_view(m_pos, end);
+				m_pos = end + 1;
+				m_scanned = m_pos;
+				record = m_record;
+				return true;
+			}
+
+			if (m_eof)
+			{
+				if (m_pos == m_filled) return false;
+
+				m_record = string_view(m_pos, m_filled);
+				m_pos = m_filled;
+				m_scanned = m_filled;
+				record = m_record;
+				return true;
+			}
+
+			// the partial record has no delimiter, only what the refill brings needs to be searched
+			m_scanned = m_filled;
+			refill();
+		}
+	}
+
+	nativa::string record_reader::promote()
+	{
+		if (m_record.is_empty()) return "";
+
+		// the char after a record is its delimiter, which has been consumed,
+		// or the spare char after the buffer
+		char* end = const_cast<char*>(m_record.end());
+		*end = '\0';
+
+		m_block->counter += 1;
+		return string_internals::adopt(m_block, m_record.begin(), end);
+	}
+
+	void record_reader::refill()
+	{
+		const size_t partial = m_filled - m_pos;
+		const size_t scanned = m_scanned - m_pos;
+		const bool full = partial == m_block->capacity;
+
+		if (m_block->counter == 1 && !full)
+		{
+			// nobody else looks at the buffer, move the unfinished record to its front
+			std::memmove(m_block->data(), m_pos, partial);
+		}
+		else
+		{
+			// promoted strings still use the buffer, or the record does not fit in it
+			block* fresh = block::create(full ? m_block->capacity * 2 : m_block->capacity);
+			std::memcpy(fresh->data(), m_pos, partial);
+			block::drop(m_block);
+			m_block = fresh;
+		}
+
+		char* data = m_block->data();
+		m_pos = data;
+		m_scanned = data + scanned;
+		m_filled = data + partial;
+
+		size_t got = read_some(m_filled, m_block->capacity - partial);
+		if (got == 0) m_eof = true;
+		m_filled += got;
+	}
+
+	size_t record_reader::read_some(char* into, size_t max)
+	{
+		for (;;)
+		{
+#ifdef _WIN32
+			const unsigned chunk = max > 0x40000000 ? 0x40000000 : static_cast<unsigned>(max);
+			auto got = ::_read(m_fd, into, chunk);
+#else
+			auto got = ::read(m_fd, into, max);
+#endif
+			if (got >= 0) return static_cast<size_t>(got);
+			if (errno == EINTR) continue;
+			throw std::system_error(errno, std::generic_category(), "read");
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef NATIVA_RECORD_READER
+#define NATIVA_RECORD_READER
+
+#include <cstddef>
+#include "string.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Reads delimited records from a file descriptor through one large reused buffer.
+	/// The records are views into the buffer, valid until the next call to next,
+	/// unless promoted to strings, which keep their part of the buffer alive.
+	/// </summary>
+	class record_reader
+	{
+	public:
+		/// <summary>
+		/// Creates a reader, which does not take the ownership of the descriptor.
+		/// </summary>
+		/// <param name="fd">The descriptor to read from, a file, a pipe or a socket</param>
+		/// <param name="delim">The char ending each record</param>
+		/// <param name="buffer_size">The initial size of the buffer, doubled whenever a record does not fit</param>
+		record_reader(int fd, char delim = '\n', size_t buffer_size = size_t(1) << 20);
+
+		record_reader(const record_reader&) = delete;
+
+		record_reader& operator=(const record_reader&) = delete;
+
+		~record_reader() noexcept;
+
+		/// <summary>
+		/// Reads the next record, without its delimiter.
+		/// The last record needs no delimiter, and is not empty.
+		/// </summary>
+		/// <param name="record">Set to the record if there is one</param>
+		/// <returns>false if the input is used up</returns>
+		/// <exception cref="std::system_error">Reading from the descriptor fails</exception>
+		bool next(nativa::string_view& record);
+
+		/// <summary>
+		/// Turns the record last read into a string without copying it.
+		/// The string shares the buffer, which the reader leaves alone from then on
+		/// and replaces with a new one when it needs to refill.
+		/// </summary>
+		nativa::string promote();
+
+	private:
+		struct block;
+
+		int m_fd;
+
+		char m_delim;
+
+		block* m_block;
+
+		const char* m_pos;
+
+		char* m_filled;
+
+		/// <summary>
+		/// Where the search for the next delimiter goes on after a refill
+		/// </summary>
+		const char* m_scanned;
+
+		bool m_eof;
+
+		nativa::string_view m_record;
+
+		void refill();
+
+		size_t read_some(char* into, size_t max);
+	};
+}
+
+#endif
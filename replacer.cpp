@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "replacer.h"
+
+namespace nativa
+{
+	replacer::replacer(std::initializer_list<std::pair<string_view, string_view>> pairs)
+		: m_starts{}
+	{
+		std::vector<char> first_chars;
+		for (const auto& given : pairs)
+		{
+			assert(!given.first.is_empty());
+			m_pairs.push_back(pair{ given.first.clone(), given.second.clone() });
+			first_chars.push_back(*given.first.begin());
+		}
+		m_first_chars = char_set(string_view(first_chars.data(), first_chars.data() + first_chars.size()));
+
+		std::stable_sort(m_pairs.begin(), m_pairs.end(), [](const pair& left, const pair& right)
+		{
+			return static_cast<uint8_t>(*left.from.begin()) < static_cast<uint8_t>(*right.from.begin());
+		});
+
+		for (const auto& sorted : m_pairs)
+		{
+			m_starts[static_cast<uint8_t>(*sorted.from.begin()) + 1] += 1;
+		}
+		for (size_t c = 0; c < 256; ++c)
+		{
+			m_starts[c + 1] += m_starts[c];
+		}
+	}
+
+	const char* replacer::find_match(const char* it, const char* end, const pair*& matched) const
+	{
+		for (;; ++it)
+		{
+			it = m_first_chars.find_in(it, end);
+			if (it == end) return end;
+
+			const uint8_t c = static_cast<uint8_t>(*it);
+			const size_t left = static_cast<size_t>(end - it);
+			for (size_t i = m_starts[c]; i < m_starts[c + 1]; ++i)
+			{
+				const pair& candidate = m_pairs[i];
+				const size_t size = candidate.from.size();
+				if (size <= left && std::memcmp(it, candidate.from.begin(), size) == 0)
+				{
+					matched = &candidate;
+					return it;
+				}
+			}
+		}
+	}
+
+	nativa::string replacer::replace_from(const string_view& source, const char* first, const pair* first_pair) const
+	{
+		const char* const end = source.end();
+
+		size_t new_size = source.size();
+		const pair* matched = first_pair;
+		for (const char* it = first; it != end; it = find_match(it + matched->from.size(), end, matched))
+		{
+			new_size = new_size - matched->from.size() + matched->to.size();
+		}
+		if (new_size == 0) return string("");
+
+		char* mutable_raw;
+		auto res = string_internals::alloc(new_size, mutable_raw);
+
+		const char* copied = source.begin();
+		matched = first_pair;
+		for (const char* it = first; it != end; it = find_match(copied, end, matched))
+		{
+			mutable_raw = std::copy(copied, it, mutable_raw);
+			mutable_raw = std::copy(matched->to.begin(), matched->to.end(), mutable_raw);
+			copied = it + matched->from.size();
+		}
+		std::copy(copied, end, mutable_raw);
+		return std::move(res);
+	}
+
+	nativa::string replacer::replace_all(const string_view& source) const
+	{
+		const pair* matched = nullptr;
+		const char* first = find_match(source.begin(), source.end(), matched);
+		if (first == source.end()) return source.clone();
+		return replace_from(source, first, matched);
+	}
+
+	nativa::string replacer::replace_all(const nativa::string& source) const
+	{
+		const pair* matched = nullptr;
+		const char* first = find_match(source.begin(), source.end(), matched);
+		if (first == source.end()) return source;
+		return replace_from(source, first, matched);
+	}
+}
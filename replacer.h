@@ -0,0 +1,75 @@
+#pragma once
+#ifndef NATIVA_REPLACER
+#define NATIVA_REPLACER
+
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "string.h"
+#include "char_set.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// Replaces several string_views in one pass, compiled once for repeated use.
+	/// The input is scanned left to right; at each position the pair given first
+	/// among those matching wins, and the scan resumes after its match,
+	/// so replacements are never replaced again.
+	/// </summary>
+	class replacer
+	{
+	public:
+		/// <summary>
+		/// Creates a replacer from pairs of what to replace and the replacement.
+		/// </summary>
+		/// <param name="pairs">The pairs; what to replace should not be empty</param>
+		replacer(std::initializer_list<std::pair<string_view, string_view>> pairs);
+
+		/// <summary>
+		/// Replaces every match in the given string_view.
+		/// The matches are counted before anything is copied,
+		/// so that the result is allocated once at its exact size.
+		/// </summary>
+		/// <returns>A new string, which is a clone when nothing is replaced</returns>
+		nativa::string replace_all(const string_view& source) const;
+
+		/// <summary>
+		/// Same as replace_all(const string_view&), but shares the source when nothing is replaced.
+		/// </summary>
+		nativa::string replace_all(const nativa::string& source) const;
+
+	private:
+		struct pair
+		{
+			nativa::string from;
+			nativa::string to;
+		};
+
+		/// <summary>
+		/// The pairs ordered by the first char of what they replace,
+		/// keeping the given order among those sharing it.
+		/// </summary>
+		std::vector<pair> m_pairs;
+
+		/// <summary>
+		/// The pairs starting with char c are [m_starts[c], m_starts[c + 1]).
+		/// </summary>
+		size_t m_starts[257];
+
+		char_set m_first_chars;
+
+		/// <summary>
+		/// Finds the first match at or after it.
+		/// </summary>
+		/// <returns>Pointer to the match, or end if there is none, in which case matched is untouched</returns>
+		const char* find_match(const char* it, const char* end, const pair*& matched) const;
+
+		/// <summary>
+		/// Builds the result, the first match being known.
+		/// </summary>
+		nativa::string replace_from(const string_view& source, const char* first, const pair* first_pair) const;
+	};
+}
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef NATIVA_SIMD
+#define NATIVA_SIMD
+
+// Internal header picking the instruction sets the kernels may use.
+// Every kernel keeps a scalar path, so none of these is required.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NATIVA_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// MSVC has no macro for SSSE3, which is implied by AVX
+#if defined(NATIVA_SIMD_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#define NATIVA_SIMD_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(NATIVA_SIMD_SSSE3) && defined(__AVX2__)
+#define NATIVA_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+// carry-less multiplication, which MSVC has no macro for either
+#if defined(NATIVA_SIMD_SSE2) && defined(__PCLMUL__)
+#define NATIVA_SIMD_CLMUL 1
+#include <wmmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nativa
+{
+	namespace simd
+	{
+		/// <summary>
+		/// Index of the lowest set bit, the mask must not be zero.
+		/// </summary>
+		inline unsigned lowest_bit(uint32_t mask)
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+		}
+
+		/// <summary>
+		/// Index of the lowest set bit, the mask must not be zero.
+		/// </summary>
+		inline unsigned lowest_bit(uint64_t mask)
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward64(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+		}
+
+		/// <summary>
+		/// Index of the highest set bit, the mask must not be zero.
+		/// </summary>
+		inline unsigned highest_bit(uint32_t mask)
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanReverse(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(31 - __builtin_clz(mask));
+#endif
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,316 @@
+#pragma once
+#ifndef NATIVA_STATIC_STRING_MAP
+#define NATIVA_STATIC_STRING_MAP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "string_view.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// A read-only map from a fixed set of keywords to values, built entirely at compile time.
+	/// The keywords are placed by a minimal perfect hash (hash and displace):
+	/// every keyword is first sent to a bucket, and each bucket stores the seed
+	/// sending all of its keywords to free slots, so a lookup is one hash,
+	/// two table reads and one comparison a word at a time, and there is nothing
+	/// to initialize at runtime.
+	/// </summary>
+	/// <typeparam name="Value">The mapped type, which should be a literal type</typeparam>
+	/// <typeparam name="N">The number of keywords</typeparam>
+	template <typename Value, size_t N>
+	class static_string_map
+	{
+		static_assert(N > 0, "A static_string_map needs at least one keyword");
+
+	public:
+		using entry = std::pair<string_view, Value>;
+
+		/// <summary>
+		/// Builds the map; fails to compile if a keyword is repeated.
+		/// </summary>
+		/// <param name="entries">The keywords and their values</param>
+		consteval static_string_map(const entry(&entries)[N]);
+
+		/// <summary>
+		/// Finds the value of a keyword.
+		/// </summary>
+		/// <returns>Pointer to the value, or nullptr if it is not a keyword</returns>
+		constexpr const Value* find(const string_view& key) const;
+
+		constexpr bool contains(const string_view& key) const;
+
+		/// <summary>
+		/// Gets the value of a keyword, or the fallback if it is not one.
+		/// </summary>
+		constexpr Value value_or(const string_view& key, const Value& fallback) const;
+
+		constexpr size_t size() const;
+
+		// the entries, in the order of their slots
+
+		constexpr const entry* begin() const;
+
+		constexpr const entry* end() const;
+
+	private:
+		// about two keywords a bucket, which keeps the seeds quick to find
+		static constexpr size_t bucket_count = N / 2 + 1;
+
+		size_t m_seeds[bucket_count];
+
+		entry m_slots[N];
+
+		/// <summary>
+		/// Hashes a keyword a word at a time, rather than a char at a time like nativa::hash,
+		/// as keywords are short and a lookup is little else.
+		/// </summary>
+		static constexpr uint64_t hash_key(const string_view& key);
+
+		/// <summary>
+		/// Reads 4 or 8 chars as a little endian integer.
+		/// </summary>
+		static constexpr uint64_t read(const char* at, size_t count);
+
+		/// <summary>
+		/// Compares chars of the same size word by word.
+		/// </summary>
+		static constexpr bool same_words(const char* left, const char* right, size_t size);
+
+		/// <summary>
+		/// Scrambles a keyword's hash with a seed, seed 0 giving its bucket.
+		/// </summary>
+		static constexpr size_t mix(uint64_t hash, size_t seed);
+	};
+
+	/// <summary>
+	/// Builds a static_string_map with the value type given and the size deduced:
+	/// constexpr auto methods = make_static_string_map&lt;method&gt;({ { "GET", method::get }, ... });
+	/// </summary>
+	template <typename Value, size_t N>
+	consteval static_string_map<Value, N> make_static_string_map(const std::pair<string_view, Value>(&entries)[N]);
+
+#pragma region Template Function Impl
+
+	template <typename Value, size_t N>
+	inline constexpr uint64_t static_string_map<Value, N>::read(const char* at, size_t count)
+	{
+		if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+		{
+			if (count == 8)
+			{
+				uint64_t res;
+				std::memcpy(&res, at, 8);
+				return res;
+			}
+			uint32_t res;
+			std::memcpy(&res, at, 4);
+			return res;
+		}
+
+		uint64_t res = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			res |= static_cast<uint64_t>(static_cast<uint8_t>(at[i])) << (8 * i);
+		}
+		return res;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr uint64_t static_string_map<Value, N>::hash_key(const string_view& key)
+	{
+		const uint64_t multiplier = 0xD6E8FEB86659FD93ull;
+		const char* const at = key.begin();
+		const size_t size = key.size();
+
+		// the words may overlap, the size telling apart what they cannot
+		uint64_t res = size * 0x9E3779B97F4A7C15ull;
+		if (size >= 8)
+		{
+			for (size_t i = 0; i + 8 < size; i += 8)
+			{
+				res = (res ^ read(at + i, 8)) * multiplier;
+			}
+			res = (res ^ read(at + size - 8, 8)) * multiplier;
+		}
+		else if (size >= 4)
+		{
+			res = (res ^ (read(at, 4) << 32 | read(at + size - 4, 4))) * multiplier;
+		}
+		else if (size > 0)
+		{
+			const uint64_t first = static_cast<uint8_t>(at[0]);
+			const uint64_t middle = static_cast<uint8_t>(at[size / 2]);
+			const uint64_t last = static_cast<uint8_t>(at[size - 1]);
+			res = (res ^ (first | middle << 8 | last << 16)) * multiplier;
+		}
+		return res ^ (res >> 32);
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr size_t static_string_map<Value, N>::mix(uint64_t hash, size_t seed)
+	{
+		uint64_t x = hash + static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull;
+		x ^= x >> 32;
+		x *= 0xD6E8FEB86659FD93ull;
+		x ^= x >> 32;
+		return static_cast<size_t>(x);
+	}
+
+	template <typename Value, size_t N>
+	inline consteval static_string_map<Value, N>::static_string_map(const entry(&entries)[N])
+		: m_seeds{}, m_slots{}
+	{
+		uint64_t hashes[N] = {};
+		for (size_t i = 0; i < N; ++i)
+		{
+			hashes[i] = hash_key(entries[i].first);
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (entries[j].first == entries[i].first) throw std::logic_error("A keyword is repeated");
+				// no seed could ever tell these apart
+				if (hashes[j] == hashes[i]) throw std::logic_error("Two keywords have the same hash");
+			}
+		}
+
+		// group the keywords by bucket
+		size_t bucket_sizes[bucket_count] = {};
+		for (size_t i = 0; i < N; ++i)
+		{
+			bucket_sizes[mix(hashes[i], 0) % bucket_count] += 1;
+		}
+		size_t bucket_starts[bucket_count + 1] = {};
+		for (size_t b = 0; b < bucket_count; ++b)
+		{
+			bucket_starts[b + 1] = bucket_starts[b] + bucket_sizes[b];
+		}
+		size_t members[N] = {};
+		size_t filled[bucket_count] = {};
+		for (size_t i = 0; i < N; ++i)
+		{
+			const size_t b = mix(hashes[i], 0) % bucket_count;
+			members[bucket_starts[b] + filled[b]++] = i;
+		}
+
+		// the largest buckets are placed first, while most slots are free
+		size_t order[bucket_count] = {};
+		for (size_t b = 0; b < bucket_count; ++b) order[b] = b;
+		for (size_t i = 0; i < bucket_count; ++i)
+		{
+			for (size_t j = i + 1; j < bucket_count; ++j)
+			{
+				if (bucket_sizes[order[j]] > bucket_sizes[order[i]]) std::swap(order[i], order[j]);
+			}
+		}
+
+		bool taken[N] = {};
+		for (size_t i = 0; i < bucket_count; ++i)
+		{
+			const size_t b = order[i];
+			if (bucket_sizes[b] == 0) break;
+
+			for (size_t seed = 1;; ++seed)
+			{
+				size_t slots[N] = {};
+				bool fits = true;
+				for (size_t k = 0; k < bucket_sizes[b] && fits; ++k)
+				{
+					slots[k] = mix(hashes[members[bucket_starts[b] + k]], seed) % N;
+					if (taken[slots[k]]) fits = false;
+					for (size_t l = 0; l < k && fits; ++l)
+					{
+						if (slots[l] == slots[k]) fits = false;
+					}
+				}
+				if (!fits) continue;
+
+				m_seeds[b] = seed;
+				for (size_t k = 0; k < bucket_sizes[b]; ++k)
+				{
+					taken[slots[k]] = true;
+					m_slots[slots[k]] = entries[members[bucket_starts[b] + k]];
+				}
+				break;
+			}
+		}
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr const Value* static_string_map<Value, N>::find(const string_view& key) const
+	{
+		const uint64_t key_hash = hash_key(key);
+		const size_t slot = mix(key_hash, m_seeds[mix(key_hash, 0) % bucket_count]) % N;
+		const entry& found = m_slots[slot];
+		if (found.first.size() != key.size()) return nullptr;
+		return same_words(found.first.begin(), key.begin(), key.size()) ? &found.second : nullptr;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr bool static_string_map<Value, N>::same_words(const char* left, const char* right, size_t size)
+	{
+		// the same reads as hash_key, no call for the short keys
+		if (size >= 8)
+		{
+			for (size_t i = 0; i + 8 < size; i += 8)
+			{
+				if (read(left + i, 8) != read(right + i, 8)) return false;
+			}
+			return read(left + size - 8, 8) == read(right + size - 8, 8);
+		}
+		if (size >= 4)
+		{
+			return read(left, 4) == read(right, 4) && read(left + size - 4, 4) == read(right + size - 4, 4);
+		}
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (left[i] != right[i]) return false;
+		}
+		return true;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr bool static_string_map<Value, N>::contains(const string_view& key) const
+	{
+		return find(key) != nullptr;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr Value static_string_map<Value, N>::value_or(const string_view& key, const Value& fallback) const
+	{
+		const Value* found = find(key);
+		return found != nullptr ? *found : fallback;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr size_t static_string_map<Value, N>::size() const
+	{
+		return N;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr const typename static_string_map<Value, N>::entry* static_string_map<Value, N>::begin() const
+	{
+		return m_slots;
+	}
+
+	template <typename Value, size_t N>
+	inline constexpr const typename static_string_map<Value, N>::entry* static_string_map<Value, N>::end() const
+	{
+		return m_slots + N;
+	}
+
+	template <typename Value, size_t N>
+	inline consteval static_string_map<Value, N> make_static_string_map(const std::pair<string_view, Value>(&entries)[N])
+	{
+		return static_string_map<Value, N>(entries);
+	}
+
+#pragma endregion
+}
+
+#endif
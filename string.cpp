@@ -1,36 +1,233 @@
 #include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstring>
 #include "string.h"
+#include "external_string.h"
+#include "instrumentation.h"
 
 #pragma region String Utils
 
 namespace nativa
 {
+	namespace
+	{
+		bool ascii_only(const char* begin, const char* end)
+		{
+			// eight chars a time, any high bit set means non-ASCII
+			const uint64_t high_bits = 0x8080808080808080ull;
+			uint64_t acc = 0;
+			for (; end - begin >= 8; begin += 8)
+			{
+				uint64_t word;
+				std::memcpy(&word, begin, 8);
+				acc |= word;
+			}
+			for (; begin != end; ++begin)
+			{
+				acc |= static_cast<uint8_t>(*begin);
+			}
+			return (acc & high_bits) == 0;
+		}
+
+		size_t utf8_code_points(const char* begin, const char* end)
+		{
+			// steps from lead byte to lead byte as utf8::access_iterator does,
+			// so that invalid sequences are counted the same way
+			size_t res = 0;
+			size_t left = static_cast<size_t>(end - begin);
+			while (left != 0)
+			{
+				const uint8_t c = static_cast<uint8_t>(*begin);
+				size_t step = 1;
+				if (c & 0b10000000)
+				{
+					step += 1;
+					if (c & 0b00100000)
+					{
+						step += 1;
+						if (c & 0b00010000) step += 1;
+					}
+				}
+				if (step > left) step = left;
+				begin += step;
+				left -= step;
+				++res;
+			}
+			return res;
+		}
+
+		// a block of several strings, which cannot tell its size from any of them
+		struct shared_block : string_header
+		{
+			size_t bytes;
+
+			static void destroy(string_header* header)
+			{
+				shared_block* disposed = static_cast<shared_block*>(header);
+				NATIVA_COUNT_FREE(disposed->bytes);
+				delete[] reinterpret_cast<char*>(disposed);
+			}
+		};
+	}
 #pragma endregion
+
 	string string_internals::alloc(size_t length, char*& mutable_raw)
 	{
 		// The memory looks like:
-		// [ counter ] [ string ] [ \0 ]
+		// [ header ] [ string ] [ \0 ] [ spare chars, none here ]
 		assert(length > 0);
 
-		size_t buffer_len = sizeof(ref_counter_t) + length + 1;
+		size_t buffer_len = sizeof(string_header) + length + 1;
 		char* buffer = new char[buffer_len];
+		NATIVA_COUNT_ALLOCATION(buffer_len);
 
-		ref_counter_t* counter = reinterpret_cast<ref_counter_t*>(buffer);
-		*counter = 1;
+		string_header* header = reinterpret_cast<string_header*>(buffer);
+		header->counter = 1;
+		header->flags = 0;
+		header->spare = 0;
+		header->size = length;
+		header->release = nullptr;
 
-		mutable_raw = buffer + sizeof(ref_counter_t);
+		mutable_raw = buffer + sizeof(string_header);
 
 		char* end = mutable_raw + length;
 		*end = '\0';
 
-		return string(counter, mutable_raw, end);
+		return string(header, mutable_raw, end);
+	}
+
+	string string_internals::adopt(string_header* header, const char* begin, const char* end)
+	{
+		assert(header != nullptr && header->release != nullptr);
+		assert((header->flags & string_header::unterminated) || *end == '\0');
+
+		return string(header, begin, end);
+	}
+
+	string string_internals::of_literal(const char* begin, const char* end)
+	{
+		assert(*end == '\0');
+
+		return string(nullptr, begin, end);
+	}
+
+	string_header* string_internals::alloc_shared(size_t length, char*& mutable_raw)
+	{
+		// The memory looks like:
+		// [ header ] [ string ] [ \0 ] [ string ] [ \0 ] ...
+		assert(length > 0);
+
+		size_t buffer_len = sizeof(shared_block) + length;
+		char* buffer = new char[buffer_len];
+		NATIVA_COUNT_ALLOCATION(buffer_len);
+
+		shared_block* block = reinterpret_cast<shared_block*>(buffer);
+		block->counter = 0;
+		block->flags = string_header::shared;
+		block->spare = 0;
+		block->size = 0;
+		block->release = shared_block::destroy;
+		block->bytes = buffer_len;
+
+		mutable_raw = buffer + sizeof(shared_block);
+		return block;
 	}
 
 	void string_internals::free(string&& disposed)
 	{
-		assert(disposed.m_counter != nullptr);
+		string_header* header = disposed.m_header;
+		assert(header != nullptr);
+
+		if (header->release != nullptr)
+		{
+			header->release(header);
+		}
+		else
+		{
+			NATIVA_COUNT_FREE(sizeof(string_header) + disposed.size() + 1 + header->spare);
+			delete[] reinterpret_cast<char*>(header);
+		}
+	}
+
+	string_header* string_internals::take_block(string& str, size_t& capacity)
+	{
+		string_header* header = str.m_header;
+		if (header == nullptr || header->release != nullptr || header->counter != 1) return nullptr;
+
+		capacity = str.size() + header->spare;
+		str.m_header = nullptr;
+		static_cast<string_view&>(str) = string_view();
+		return header;
+	}
+
+	string_header* string_internals::resize_block(string_header* block, size_t size, size_t old_capacity, size_t capacity)
+	{
+		assert(capacity > 0 && size <= capacity && size <= old_capacity);
+
+		// a new block and a copy, as realloc would mostly do anyway,
+		// which keeps the blocks to new[] like all the others
+		size_t buffer_len = sizeof(string_header) + capacity + 1;
+		char* buffer = new char[buffer_len];
+		NATIVA_COUNT_ALLOCATION(buffer_len);
+
+		string_header* res = reinterpret_cast<string_header*>(buffer);
+		res->counter = 1;
+		res->flags = 0;
+		res->spare = 0;
+		res->size = 0;
+		res->release = nullptr;
+		if (block != nullptr)
+		{
+			std::memcpy(chars_of(res), chars_of(block), size);
+			free_block(block, old_capacity);
+		}
+		return res;
+	}
+
+	string string_internals::give_block(string_header* block, size_t size, size_t capacity)
+	{
+		assert(size <= capacity);
+		if (size == 0)
+		{
+			free_block(block, capacity);
+			return string("");
+		}
+
+		// the chars have changed, so has everything cached about them
+		block->flags = 0;
+		block->spare = capacity - size <= UINT_MAX ? static_cast<unsigned>(capacity - size) : UINT_MAX;
+		block->size = size;
+		char* begin = chars_of(block);
+		begin[size] = '\0';
+		return string(block, begin, begin + size);
+	}
+
+	void string_internals::free_block(string_header* block, [[maybe_unused]] size_t capacity)
+	{
+		NATIVA_COUNT_FREE(sizeof(string_header) + capacity + 1);
+		delete[] reinterpret_cast<char*>(block);
+	}
+
+	char* string_internals::chars_of(string_header* block)
+	{
+		return reinterpret_cast<char*>(block + 1);
+	}
 
-		delete disposed.m_counter;
+	string_header* string_internals::block_of(const string& str)
+	{
+		string_header* header = str.m_header;
+		if (header == nullptr || header->release != nullptr) return nullptr;
+		return str.m_begin == chars_of(header) && str.size() == header->size ? header : nullptr;
+	}
+
+	string string_internals::share_block(string_header* block)
+	{
+		assert(block != nullptr && block->release == nullptr);
+		NATIVA_COUNT(ref_increments);
+		block->counter += 1;
+		char* begin = chars_of(block);
+		return string(block, begin, begin + block->size);
 	}
 
 	string string::substring(size_t begin, size_t length) const
@@ -38,6 +235,60 @@ namespace nativa
 		return this->slice(begin, length).clone();
 	}
 
+	string string::append(const string_view& tail) &&
+	{
+		const size_t size = this->size();
+		const size_t extra = tail.size();
+		if (extra == 0) return std::move(*this);
+
+		// a tail within this string has to be found again if the block moves
+		const bool inner = tail.begin() >= m_begin && tail.begin() < m_end;
+		const size_t offset = tail.begin() - m_begin;
+
+		size_t capacity;
+		string_header* block = string_internals::take_block(*this, capacity);
+		if (block == nullptr)
+		{
+			char* mutable_raw;
+			auto res = string_internals::alloc(size + extra, mutable_raw);
+			this->copy_to(mutable_raw);
+			tail.copy_to(mutable_raw + size);
+			return res;
+		}
+
+		if (size + extra > capacity)
+		{
+			NATIVA_COUNT(builder_regrowths);
+			const size_t old_capacity = capacity;
+			capacity = size + extra > size + size / 2 ? size + extra : size + size / 2;
+			block = string_internals::resize_block(block, size, old_capacity, capacity);
+		}
+		char* chars = string_internals::chars_of(block);
+		std::memcpy(chars + size, inner ? chars + offset : tail.begin(), extra);
+		return string_internals::give_block(block, size + extra, capacity);
+	}
+
+	string string::append(char c) &&
+	{
+		return std::move(*this).append(string_view(&c, &c + 1));
+	}
+
+	string string::replace(const string_view& from, const string_view& to) const
+	{
+		assert(!from.is_empty());
+		const char* first = find(from, m_begin);
+		if (first == m_end) return *this;
+		return replace_from(first, from, to, 1);
+	}
+
+	string string::replace_all(const string_view& from, const string_view& to) const
+	{
+		assert(!from.is_empty());
+		const char* first = find(from, m_begin);
+		if (first == m_end) return *this;
+		return replace_from(first, from, to, static_cast<size_t>(-1));
+	}
+
 	string_view string::view() const
 	{
 		return string_view(m_begin, m_end);
@@ -45,7 +296,8 @@ namespace nativa
 
 	const char* string::c_str() const
 	{
-		return this->m_begin;
+		if (m_header == nullptr || !(m_header->load_flags() & string_header::unterminated)) return this->m_begin;
+		return static_cast<external_header*>(m_header)->c_str();
 	}
 
 	string::operator const char*() const
@@ -55,36 +307,108 @@ namespace nativa
 
 	ref_counter_t string::ref_count() const
 	{
-		if (m_counter == nullptr) return 0;
-		return *m_counter;
+		if (m_header == nullptr) return 0;
+		return m_header->counter;
+	}
+
+	bool string::caches_metadata() const
+	{
+		return m_header != nullptr && !(m_header->load_flags() & string_header::shared);
+	}
+
+	size_t string::hash() const
+	{
+		if (!caches_metadata()) return std::hash<string_view>()(*this);
+
+		if (!(m_header->load_flags() & string_header::hash_cached))
+		{
+			m_header->store_cached(m_header->hash, std::hash<string_view>()(*this));
+			m_header->add_flags(string_header::hash_cached);
+		}
+		return m_header->load_cached(m_header->hash);
+	}
+
+	bool string::is_ascii() const
+	{
+		if (!caches_metadata()) return ascii_only(m_begin, m_end);
+
+		unsigned flags = m_header->load_flags();
+		if (!(flags & string_header::ascii_cached))
+		{
+			// both bits at once, so that nobody sees the answer cached before it is
+			flags = ascii_only(m_begin, m_end) ? string_header::ascii_cached | string_header::ascii : string_header::ascii_cached;
+			m_header->add_flags(flags);
+		}
+		return (flags & string_header::ascii) != 0;
 	}
 
-	string::string(ref_counter_t* counter, const char* begin, const char* end) noexcept
-		: m_counter(counter), string_view(begin, end)
+	size_t string::utf8_length() const
+	{
+		if (!caches_metadata()) return utf8_code_points(m_begin, m_end);
+
+		if (!(m_header->load_flags() & string_header::code_points_cached))
+		{
+			m_header->store_cached(m_header->code_points, is_ascii()
+				? size()
+				: utf8_code_points(m_begin, m_end));
+			m_header->add_flags(string_header::code_points_cached);
+		}
+		return m_header->load_cached(m_header->code_points);
+	}
+
+	bool operator==(const string& left, const string& right)
+	{
+		if (left.size() != right.size()) return false;
+		if (left.begin() == right.begin()) return true;
+
+		// only trust hashes that are already there, computing one costs a full scan anyway
+		const string_header* lh = left.m_header;
+		const string_header* rh = right.m_header;
+		if (lh != nullptr && rh != nullptr
+			&& (lh->load_flags() & rh->load_flags() & string_header::hash_cached)
+			&& lh->load_cached(lh->hash) != rh->load_cached(rh->hash))
+		{
+			return false;
+		}
+
+		return left.view() == right.view();
+	}
+
+	bool operator!=(const string& left, const string& right)
+	{
+		return !(left == right);
+	}
+
+	string::string(string_header* header, const char* begin, const char* end) noexcept
+		: m_header(header), string_view(begin, end)
 	{
 	}
 
 	string::string(const string& str) noexcept
-		: m_counter(str.m_counter), string_view(str.m_begin, str.m_end)
+		: m_header(str.m_header), string_view(str.m_begin, str.m_end)
 	{
-		if (m_counter)
+		NATIVA_COUNT(copies);
+		if (m_header)
 		{
-			*m_counter += 1;
+			NATIVA_COUNT(ref_increments);
+			m_header->counter += 1;
 		}
 	}
 	
 	string::string(string&& str) noexcept
-		: m_counter(str.m_counter), string_view(str.m_begin, str.m_end)
+		: m_header(str.m_header), string_view(str.m_begin, str.m_end)
 	{
-		str.m_counter = nullptr;
+		NATIVA_COUNT(moves);
+		str.m_header = nullptr;
 	}
 
 	string::~string() noexcept
 	{
-		if (m_counter)
+		if (m_header)
 		{
-			*m_counter -= 1;
-			if (*m_counter == 0)
+			NATIVA_COUNT(ref_decrements);
+			m_header->counter -= 1;
+			if (m_header->counter == 0)
 			{
 				// move is used to supress ref count change
 				string_internals::free(std::move(*this));
@@ -96,6 +420,8 @@ namespace nativa
 	{
 		if (&str == this) return *this;
 
+		NATIVA_COUNT(copies);
+
 		if (str.m_begin == m_begin && str.m_end == m_end) return *this;
 		// pay attention to the ref semantics
 		// if two references refer to the same thing
@@ -105,9 +431,13 @@ namespace nativa
 		this->~string(); // but the old is not so it should look as if it has destructed
 		m_begin = str.m_begin;
 		m_end = str.m_end;
-		m_counter = str.m_counter;
+		m_header = str.m_header;
 
-		*m_counter += 1;
+		if (m_header)
+		{
+			NATIVA_COUNT(ref_increments);
+			m_header->counter += 1;
+		}
 
 		return *this;
 	}
@@ -117,15 +447,17 @@ namespace nativa
 	{
 		if (&str == this) return *this;
 
+		NATIVA_COUNT(moves);
+
 		// pay attention to this corner case:
 		// when two string own the same instance
 		// if one is moved to another
 		// the ref count goes down instead of staying unchanged
 		// (well in most cases it *is* unchanged)
-		if (this->m_counter != nullptr && str.m_begin == m_begin && str.m_end == m_end)
+		if (this->m_header != nullptr && str.m_begin == m_begin && str.m_end == m_end)
 		{
 			str.~string(); // decrease ref count
-			str.m_counter = nullptr; // mark the string moved from as invalid
+			str.m_header = nullptr; // mark the string moved from as invalid
 			return *this;
 		}
 
@@ -133,9 +465,9 @@ namespace nativa
 		this->~string();
 		m_begin = str.m_begin;
 		m_end = str.m_end;
-		m_counter = str.m_counter;
+		m_header = str.m_header;
 
-		str.m_counter = nullptr; // the moved-from object has no ownership anymore
+		str.m_header = nullptr; // the moved-from object has no ownership anymore
 
 		return *this;
 	}
@@ -2,17 +2,79 @@
 #ifndef NATIVA_IMMUTABLE_STRING
 #define NATIVA_IMMUTABLE_STRING
 
+#include <atomic>
 #include <cstddef>
 #include <initializer_list>
+#include <type_traits>
 #include <utility>
 #include "string_view.h"
+#include "utf8.h"
 
 namespace nativa
 {
 	using ref_counter_t = size_t;
 
+	/// <summary>
+	/// The header placed before the chars of a runtime string.
+	/// The chars never change once the string is handed out,
+	/// so metadata computed over them is cached here on first use.
+	/// </summary>
+	struct string_header
+	{
+		enum : unsigned
+		{
+			hash_cached = 1,
+			ascii_cached = 2,
+			ascii = 4,
+			code_points_cached = 8,
+			// the header is shared by different strings, so it cannot cache anything
+			shared = 16,
+			// no '\0' follows the chars, and the header is an external_header (external_string.h)
+			unterminated = 32,
+		};
+
+		ref_counter_t counter;
+		unsigned flags;
+
+		/// <summary>
+		/// Chars allocated past the '\0' of a block from string_internals::alloc,
+		/// which its only owner may append into; 0 for the other blocks.
+		/// </summary>
+		unsigned spare;
+
+		/// <summary>
+		/// The size of the string of a block from string_internals::alloc,
+		/// so that a pointer to the header is enough to find it; 0 for the other blocks.
+		/// </summary>
+		size_t size;
+
+		size_t hash;
+		size_t code_points;
+
+		/// <summary>
+		/// Releases the memory once the count drops to zero.
+		/// nullptr for the buffers made by string_internals::alloc.
+		/// </summary>
+		void (*release)(string_header* header);
+
+		// Several threads may read the same string and cache the same metadata at once,
+		// so the flags and the cached fields are accessed atomically.
+		// Setting a flag releases the field it marks as cached to those loading the flags.
+		// The counter is not atomic: copying a string shared by threads still needs a lock.
+
+		unsigned load_flags() const noexcept;
+
+		void add_flags(unsigned added) noexcept;
+
+		size_t load_cached(const size_t& field) const noexcept;
+
+		void store_cached(size_t& field, size_t value) noexcept;
+	};
+
 	struct string_internals;
 
+	class string_builder;
+
 	/// <summary>
 	/// An immutable string.
 	/// Should be easily copied.
@@ -22,6 +84,8 @@ namespace nativa
 	{
 		friend struct string_internals;
 
+		friend bool operator==(const string& left, const string& right);
+
 	public:
 
 		// Create from string literals.
@@ -59,6 +123,18 @@ namespace nativa
 
 		template <typename Enumerable = std::initializer_list<string_view>>
 		static string join(const string_view& delim, const Enumerable& enumerable);
+
+		/// <summary>
+		/// Clones several views at once into one block with one shared ref count,
+		/// instead of one allocation each. Every clone is followed by its own '\0',
+		/// and the block lives as long as any of them.
+		/// </summary>
+		/// <typeparam name="Enumerable">An enumerable of views, which is walked twice</typeparam>
+		/// <typeparam name="InsertIt">An insert iterator</typeparam>
+		/// <param name="enumerable">The views to be cloned</param>
+		/// <param name="output">The insert iterator of the collection into which the clones go</param>
+		template <typename Enumerable = std::initializer_list<string_view>, typename InsertIt>
+		static void clone_batch(const Enumerable& enumerable, InsertIt output);
 #pragma endregion
 
 		/// <summary>
@@ -70,23 +146,87 @@ namespace nativa
 		/// <returns>The substring</returns>
 		nativa::string substring(size_t begin, size_t length) const;
 
+		/// <summary>
+		/// Appends to a string which is given up, in its own block when it owns it alone:
+		/// into the spare chars of the block, or else by moving to a block with room to spare,
+		/// so that appending again and again costs amortized constant time a char.
+		/// Shared or literal strings are copied into a new string instead.
+		/// s = std::move(s).append(tail);
+		/// </summary>
+		/// <param name="tail">The chars to append, which may be part of this string</param>
+		/// <returns>The string with the chars appended</returns>
+		nativa::string append(const string_view& tail) &&;
+
+		nativa::string append(char c) &&;
+
+		/// <summary>
+		/// Gives up a string for a builder holding its chars, which takes over its block
+		/// when the string owns it alone, and copies it otherwise.
+		/// Defined with string_builder, so include string_builder.h to call it.
+		/// </summary>
+		string_builder into_builder() &&;
+
+		/// <summary>
+		/// Same as string_view::replace, but shares this string when nothing is replaced.
+		/// </summary>
+		nativa::string replace(const string_view& from, const string_view& to) const;
+
+		/// <summary>
+		/// Same as string_view::replace_all, but shares this string when nothing is replaced.
+		/// </summary>
+		nativa::string replace_all(const string_view& from, const string_view& to) const;
+
 		string_view view() const;
 
+		/// <summary>
+		/// Gets the chars followed by a '\0'. Those of an adopted external buffer
+		/// without one are copied the first time, see adopt_external.
+		/// </summary>
 		const char* c_str() const;
 
 		operator const char*() const;
 
 		ref_counter_t ref_count() const;
 
+		/// <summary>
+		/// Gets the hash of the string, equal to the std::hash of its view.
+		/// Computed once and cached for runtime strings.
+		/// </summary>
+		size_t hash() const;
+
+		/// <summary>
+		/// Checks whether every char of the string is below 0x80.
+		/// Computed once and cached for runtime strings.
+		/// </summary>
+		bool is_ascii() const;
+
+		/// <summary>
+		/// Same as string_view::length, but the UTF-8 code point count
+		/// is cached, and is simply the size for ASCII strings.
+		/// </summary>
+		template <typename Encoding>
+		size_t length() const;
+
 	private:
 		/// <summary>
 		/// Should be nullptr if not ref-counted
 		/// </summary>
-		ref_counter_t* m_counter;
+		string_header* m_header;
+
+		string(string_header* header, const char* begin, const char* end) noexcept;
 
-		string(ref_counter_t* counter, const char* begin, const char* end) noexcept;
+		size_t utf8_length() const;
+
+		bool caches_metadata() const;
 	};
 
+	/// <summary>
+	/// Compares two strings, rejecting by the cached hashes when both are known.
+	/// </summary>
+	bool operator==(const string& left, const string& right);
+
+	bool operator!=(const string& left, const string& right);
+
 	/// <summary>
 	/// Universal interface for allocation of nativa::string
 	/// The implementation should be consistent.
@@ -101,6 +241,85 @@ namespace nativa
 		/// <returns>The ready-to-use string</returns>
 		static nativa::string alloc(size_t length, char*& mutable_raw);
 
+		/// <summary>
+		/// Creates a runtime string over chars living elsewhere.
+		/// The header should have its count set, this string being one of the owners,
+		/// and a release function freeing both the chars and itself.
+		/// </summary>
+		/// <param name="header">The header, which will be shared by the copies of the string</param>
+		/// <param name="begin">The beginning of the chars</param>
+		/// <param name="end">The end of the chars, which should be followed by a '\0' unless the header is unterminated</param>
+		/// <returns>The ready-to-use string</returns>
+		static nativa::string adopt(string_header* header, const char* begin, const char* end);
+
+		/// <summary>
+		/// Creates a string over chars living as long as the program, such as a literal's, without a header.
+		/// </summary>
+		/// <param name="end">The end of the chars, which should be followed by a '\0'</param>
+		static nativa::string of_literal(const char* begin, const char* end);
+
+		/// <summary>
+		/// Allocates a block for several runtime strings sharing one header.
+		/// The header comes with the shared flag and a count of zero;
+		/// the caller raises the count for each string adopting it.
+		/// </summary>
+		/// <param name="length">Length of the block, including the '\0's of the strings</param>
+		/// <param name="mutable_raw">An out param, mutable buffer of the block</param>
+		/// <returns>The header of the block</returns>
+		static string_header* alloc_shared(size_t length, char*& mutable_raw);
+
+		/// <summary>
+		/// Takes the block of a runtime string made by alloc, if the string owns it alone,
+		/// so that its chars may be written again. The string is left empty.
+		/// </summary>
+		/// <param name="str">The string giving up its block</param>
+		/// <param name="capacity">Set to how many chars the block holds, its '\0' aside</param>
+		/// <returns>The header of the block, or nullptr if the string has no block of its own, which leaves it as it is</returns>
+		static string_header* take_block(nativa::string& str, size_t& capacity);
+
+		/// <summary>
+		/// Allocates a block, or reallocates one taken from a string, to hold more or fewer chars.
+		/// </summary>
+		/// <param name="block">The header of the block, nullptr for a new one</param>
+		/// <param name="size">How many of its chars are kept</param>
+		/// <param name="old_capacity">How many chars it held, 0 for a new one</param>
+		/// <param name="capacity">How many chars it should hold, its '\0' aside, more than 0</param>
+		/// <returns>The header of the block, which has moved</returns>
+		static string_header* resize_block(string_header* block, size_t size, size_t old_capacity, size_t capacity);
+
+		/// <summary>
+		/// Turns a block taken or resized back into a runtime string of its first chars,
+		/// the rest staying spare.
+		/// </summary>
+		/// <param name="size">How many chars are written, which may be 0 to free the block</param>
+		/// <param name="capacity">How many chars the block holds</param>
+		/// <returns>The ready-to-use string</returns>
+		static nativa::string give_block(string_header* block, size_t size, size_t capacity);
+
+		/// <summary>
+		/// Frees a block taken or resized, which no string has.
+		/// </summary>
+		static void free_block(string_header* block, size_t capacity);
+
+		/// <summary>
+		/// The chars of a block, which follow its header.
+		/// </summary>
+		static char* chars_of(string_header* block);
+
+		/// <summary>
+		/// The header of a runtime string made by alloc, which alone knows the size of its string.
+		/// </summary>
+		/// <returns>The header, its count left alone, or nullptr for the other strings,
+		/// including substrings of such a block</returns>
+		static string_header* block_of(const nativa::string& str);
+
+		/// <summary>
+		/// Makes another owner of the string of a block made by alloc.
+		/// </summary>
+		/// <param name="block">The header, whose count is raised</param>
+		/// <returns>The ready-to-use string</returns>
+		static nativa::string share_block(string_header* block);
+
 		/// <summary>
 		/// Frees the runtime string.
 		/// </summary>
@@ -110,15 +329,42 @@ namespace nativa
 
 #pragma region Template and Constexpr Function Impl
 
+	inline unsigned string_header::load_flags() const noexcept
+	{
+		return std::atomic_ref<unsigned>(const_cast<unsigned&>(flags)).load(std::memory_order_acquire);
+	}
+
+	inline void string_header::add_flags(unsigned added) noexcept
+	{
+		std::atomic_ref<unsigned>(flags).fetch_or(added, std::memory_order_release);
+	}
+
+	inline size_t string_header::load_cached(const size_t& field) const noexcept
+	{
+		return std::atomic_ref<size_t>(const_cast<size_t&>(field)).load(std::memory_order_relaxed);
+	}
+
+	inline void string_header::store_cached(size_t& field, size_t value) noexcept
+	{
+		std::atomic_ref<size_t>(field).store(value, std::memory_order_relaxed);
+	}
+
 	template <size_t N>
 	constexpr inline string::string(const char(&c_str)[N])
-		: m_counter(nullptr), string_view(c_str)
+		: m_header(nullptr), string_view(c_str)
 	{
 	}
 
 	constexpr inline string::string()
-			: m_counter(nullptr), string_view()
+			: m_header(nullptr), string_view()
+	{
+	}
+
+	template <typename Encoding>
+	inline size_t string::length() const
 	{
+		if (std::is_same<Encoding, encoding::utf8>::value) return utf8_length();
+		return string_view::length<Encoding>();
 	}
 
 	template <typename Enumerable>
@@ -202,8 +448,83 @@ namespace nativa
 		return std::move(res);
 	}
 
+	template <typename Enumerable, typename InsertIt>
+	inline void string::clone_batch(const Enumerable& enumerable, InsertIt output)
+	{
+		size_t new_size = 0;
+		size_t owners = 0;
+		auto begin = std::begin(enumerable);
+		auto end = std::end(enumerable);
+
+		static_assert(
+			std::is_convertible<decltype(*begin), string_view>::value,
+			"The elements in the enumerable should be convertible to string_view");
+
+		for (auto it = begin; it != end; ++it)
+		{
+			const string_view& view = *it;
+			if (view.size() == 0) continue;
+			new_size += view.size() + 1;
+			owners += 1;
+		}
+
+		// the batch holds a count of its own while the clones are handed out one by one,
+		// so that the block is freed with the last of them even if the output throws halfway
+		string_header* header = nullptr;
+		char* buf_it = nullptr;
+		if (owners != 0)
+		{
+			header = string_internals::alloc_shared(new_size, buf_it);
+			header->counter = 1;
+		}
+		auto release_batch = [header]
+		{
+			if (header != nullptr && --header->counter == 0) header->release(header);
+		};
+
+		try
+		{
+			for (auto it = begin; it != end; ++it)
+			{
+				const string_view& view = *it;
+				if (view.size() == 0)
+				{
+					*output = string("");
+				}
+				else
+				{
+					view.copy_to(buf_it);
+					char* view_end = buf_it + view.size();
+					*view_end = '\0';
+					header->counter += 1;
+					*output = string_internals::adopt(header, buf_it, view_end);
+					buf_it = view_end + 1;
+				}
+				++output;
+			}
+		}
+		catch (...)
+		{
+			release_batch();
+			throw;
+		}
+		release_batch();
+	}
+
 #pragma endregion
 }
 
+namespace std
+{
+	template <>
+	struct hash<nativa::string>
+	{
+		size_t operator()(const nativa::string& str) const
+		{
+			return str.hash();
+		}
+	};
+}
+
 #endif
 
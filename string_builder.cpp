@@ -1,13 +1,57 @@
+#include <cstring>
+#include <utility>
 #include "string_builder.h"
+#include "instrumentation.h"
 
 namespace nativa
 {
 	string_builder::string_builder()
+		: m_block(nullptr), m_size(0), m_capacity(0)
 	{
-		m_buffer.reserve(16);
 	}
 
-	string_builder& nativa::string_builder::append(const string_view& str)
+	string_builder::string_builder(const string_builder& another)
+		: string_builder()
+	{
+		if (another.m_size == 0) return;
+		const char* chars = string_internals::chars_of(another.m_block);
+		append(string_view(chars, chars + another.m_size));
+	}
+
+	string_builder::string_builder(string_builder&& another) noexcept
+		: m_block(another.m_block), m_size(another.m_size), m_capacity(another.m_capacity)
+	{
+		another.m_block = nullptr;
+		another.m_size = 0;
+		another.m_capacity = 0;
+	}
+
+	string_builder::~string_builder() noexcept
+	{
+		if (m_block != nullptr) string_internals::free_block(m_block, m_capacity);
+	}
+
+	string_builder& string_builder::operator=(const string_builder& another)
+	{
+		if (&another == this) return *this;
+		string_builder copy(another);
+		return *this = std::move(copy);
+	}
+
+	string_builder& string_builder::operator=(string_builder&& another) noexcept
+	{
+		if (&another == this) return *this;
+		this->~string_builder();
+		m_block = another.m_block;
+		m_size = another.m_size;
+		m_capacity = another.m_capacity;
+		another.m_block = nullptr;
+		another.m_size = 0;
+		another.m_capacity = 0;
+		return *this;
+	}
+
+	string_builder& string_builder::append(const string_view& str)
 	{
 		str.copy_to(grow(str.size()));
 		return *this;
@@ -19,49 +63,109 @@ namespace nativa
 		return *this;
 	}
 
+	void string_builder::push_back(char c)
+	{
+		*grow(1) = c;
+	}
+
 	size_t string_builder::size() const
 	{
-		return m_buffer.size();
+		return m_size;
 	}
 
 	void string_builder::shrink_to_fit()
 	{
-		m_buffer.shrink_to_fit();
+		if (m_block == nullptr || m_size == m_capacity) return;
+		if (m_size == 0)
+		{
+			string_internals::free_block(m_block, m_capacity);
+			m_block = nullptr;
+			m_capacity = 0;
+			return;
+		}
+		m_block = string_internals::resize_block(m_block, m_size, m_capacity, m_size);
+		m_capacity = m_size;
 	}
 
 	void string_builder::resize(size_t size)
 	{
-		m_buffer.resize(size);
+		if (size > m_size)
+		{
+			const size_t extra = size - m_size;
+			std::memset(grow(extra), '\0', extra);
+		}
+		m_size = size;
 	}
 
-	std::vector<char>::iterator string_builder::begin()
+	char* string_builder::begin()
 	{
-		return m_buffer.begin();
+		return m_block == nullptr ? nullptr : string_internals::chars_of(m_block);
 	}
 
-	std::vector<char>::iterator string_builder::end()
+	char* string_builder::end()
 	{
-		return m_buffer.end();
+		return m_block == nullptr ? nullptr : string_internals::chars_of(m_block) + m_size;
 	}
 
-	string string_builder::to_string()
+	string string_builder::to_string() const&
 	{
-		if (m_buffer.empty()) return "";
+		if (m_size == 0) return "";
 		char* mutable_raw;
-		string res = string_internals::alloc(m_buffer.size(), mutable_raw);
-		string_view(&m_buffer[0], &m_buffer[0] + m_buffer.size()).copy_to(mutable_raw);
-		return std::move(res);
+		string res = string_internals::alloc(m_size, mutable_raw);
+		std::memcpy(mutable_raw, string_internals::chars_of(m_block), m_size);
+		return res;
+	}
+
+	string string_builder::to_string() &&
+	{
+		if (m_block == nullptr) return "";
+		string res = string_internals::give_block(m_block, m_size, m_capacity);
+		m_block = nullptr;
+		m_size = 0;
+		m_capacity = 0;
+		return res;
 	}
 
 	char* string_builder::grow(size_t size)
 	{
-		m_buffer.resize(m_buffer.size() + size);
-		return &m_buffer[0] + m_buffer.size() - size;
-		// You cannot dereference the end iterator
+		if (size == 0) return end();
+		if (m_size + size > m_capacity)
+		{
+			const size_t doubled = m_capacity * 2;
+			reserve(m_size + size > doubled ? (m_size + size > 16 ? m_size + size : 16) : doubled);
+		}
+		char* res = string_internals::chars_of(m_block) + m_size;
+		m_size += size;
+		return res;
 	}
 
-	std::back_insert_iterator<std::vector<char>> string_builder::back_inserter()
+	void string_builder::reserve(size_t capacity)
 	{
-		return std::back_inserter(m_buffer);
+		if (m_block != nullptr) NATIVA_COUNT(builder_regrowths);
+		m_block = string_internals::resize_block(m_block, m_size, m_capacity, capacity);
+		m_capacity = capacity;
+	}
+
+	std::back_insert_iterator<string_builder> string_builder::back_inserter()
+	{
+		return std::back_insert_iterator<string_builder>(*this);
+	}
+
+	string_builder string::into_builder() &&
+	{
+		string_builder res;
+		const size_t size = this->size();
+		size_t capacity;
+		string_header* block = string_internals::take_block(*this, capacity);
+		if (block == nullptr)
+		{
+			res.append(*this);
+			return res;
+		}
+
+		res.m_block = block;
+		res.m_size = size;
+		res.m_capacity = capacity;
+		return res;
 	}
 }
@@ -2,39 +2,90 @@
 #ifndef NATIVA_STRING_BUILDER
 #define NATIVA_STRING_BUILDER
 
+#include <cassert>
 #include <cstddef>
-#include <vector>
+#include <iterator>
 #include "string.h"
 
 namespace nativa
 {
+	template <typename... Parts>
+	class concat_expr;
+
+	/// <summary>
+	/// Builds a string in a block of the same layout as a runtime string's,
+	/// so that the block becomes the string, or a string owned alone becomes the builder, without copying.
+	/// </summary>
 	class string_builder
 	{
+		friend class string;
+
 	public:
+		using value_type = char;
+
 		string_builder();
 
+		string_builder(const string_builder& another);
+
+		string_builder(string_builder&& another) noexcept;
+
+		~string_builder() noexcept;
+
+		string_builder& operator=(const string_builder& another);
+
+		string_builder& operator=(string_builder&& another) noexcept;
+
 		string_builder& append(const string_view& str);
 
 		string_builder& append(char c);
 
+		/// <summary>
+		/// Appends a concatenation made by operator+ (concat.h), growing once for all its parts.
+		/// </summary>
+		template <typename... Parts>
+		string_builder& append(const concat_expr<Parts...>& expr);
+
+		void push_back(char c);
+
 		size_t size() const;
 
 		void shrink_to_fit();
 
+		/// <summary>
+		/// Resizes the chars, the new ones being '\0'.
+		/// </summary>
 		void resize(size_t size);
 		
-		std::vector<char>::iterator begin();
+		char* begin();
+
+		char* end();
 
-		std::vector<char>::iterator end();
+		/// <summary>
+		/// Copies the chars into a string of the exact size, leaving the builder as it is.
+		/// </summary>
+		nativa::string to_string() const&;
 
-		nativa::string to_string();
+		/// <summary>
+		/// Turns the block into the string without copying, leaving the builder empty.
+		/// The room left in the block stays with the string, for string::append or into_builder.
+		/// </summary>
+		nativa::string to_string() &&;
 
-		std::back_insert_iterator<std::vector<char>> back_inserter();
+		std::back_insert_iterator<string_builder> back_inserter();
 
 	private:
-		std::vector<char> m_buffer;
+		/// <summary>
+		/// Should be nullptr until something is appended
+		/// </summary>
+		string_header* m_block;
+
+		size_t m_size;
+
+		size_t m_capacity;
 
 		char* grow(size_t size);
+
+		void reserve(size_t capacity);
 	};
 
 	template <size_t Capacity>
@@ -66,6 +117,13 @@ namespace nativa
 	};
 
 #pragma region Template Function Impl
+	template <typename... Parts>
+	inline string_builder& string_builder::append(const concat_expr<Parts...>& expr)
+	{
+		expr.write(grow(expr.size()));
+		return *this;
+	}
+
 	template <size_t Capacity>
 	inline fixed_string_builder<Capacity>::fixed_string_builder()
 	{
@@ -6,9 +6,16 @@
 #include <cstdint>
 #include <cassert>
 #include <algorithm>
+#include <type_traits>
+#include <typeinfo>
 #include "string.h"
 #include "string_builder.h"
 
+#ifndef NATIVA_SMALL_INTEGRALS
+// to_string gives the integers from 0 below this as static strings, which allocate nothing; 0 turns it off
+#define NATIVA_SMALL_INTEGRALS 10000
+#endif
+
 namespace nativa
 {
 	template <typename T>
@@ -35,6 +42,41 @@ namespace nativa
 
 		template <typename T>
 		nativa::string float_point(T value, int base, int precision);
+
+		constexpr size_t small_integral_count = NATIVA_SMALL_INTEGRALS;
+
+		// defined here, as the table below needs it for its size
+		constexpr size_t decimal_digits(size_t value)
+		{
+			size_t res = 1;
+			while (value >= 10)
+			{
+				value /= 10;
+				++res;
+			}
+			return res;
+		}
+
+		/// <summary>
+		/// The decimal strings of the integers below small_integral_count, built at compile time,
+		/// so that to_string hands them out like literals: no allocation and no ref count.
+		/// </summary>
+		class small_integral_table
+		{
+		public:
+			consteval small_integral_table();
+
+			/// <summary>
+			/// Gets the string of a value below small_integral_count.
+			/// </summary>
+			nativa::string operator[](size_t value) const;
+
+		private:
+			// a row holds the digits, the '\0' and, in its last char, the size; 8 chars for up to 6 digits
+			static constexpr size_t row_size = (decimal_digits(small_integral_count) + 2 + 7) / 8 * 8;
+
+			char m_rows[(small_integral_count > 0 ? small_integral_count : 1) * row_size];
+		};
 	}
 
 	template <typename T>
@@ -166,6 +208,35 @@ namespace nativa
 	}
 
 #pragma region Function Impl
+	inline consteval to_string_impl::small_integral_table::small_integral_table()
+		: m_rows()
+	{
+		for (size_t value = 0; value < small_integral_count; ++value)
+		{
+			char* row = m_rows + value * row_size;
+			const size_t digits = decimal_digits(value);
+			size_t rest = value;
+			for (size_t i = digits; i != 0; --i)
+			{
+				row[i - 1] = static_cast<char>('0' + rest % 10);
+				rest /= 10;
+			}
+			row[row_size - 1] = static_cast<char>(digits);
+		}
+	}
+
+	namespace to_string_impl
+	{
+		inline constexpr small_integral_table small_integrals;
+	}
+
+	inline nativa::string to_string_impl::small_integral_table::operator[](size_t value) const
+	{
+		assert(value < small_integral_count);
+		const char* row = m_rows + value * row_size;
+		return string_internals::of_literal(row, row + row[row_size - 1]);
+	}
+
 	template <typename T>
 	inline T parse_unsigned_integral(const nativa::string_view& str)
 	{
@@ -218,6 +289,7 @@ namespace nativa
 	inline nativa::string to_string_impl::unsigned_integral(T value, unsigned base)
 	{
 		assert(2 <= base && base <= 36);
+		if (base == 10 && value < small_integral_count) return small_integrals[value];
 		if (value == 0) return "0";
 
 		fixed_string_builder<128> builder;
@@ -231,6 +303,10 @@ namespace nativa
 	nativa::string to_string_impl::signed_integral(T value, unsigned base)
 	{
 		assert(2 <= base && base <= 36);
+		if (base == 10 && value >= 0 && static_cast<std::make_unsigned_t<T>>(value) < small_integral_count)
+		{
+			return small_integrals[static_cast<size_t>(value)];
+		}
 		if (value == 0) return "0";
 
 		fixed_string_builder<128> builder;
@@ -0,0 +1,780 @@
+#pragma once
+#ifndef NATIVA_STRING_MAP
+#define NATIVA_STRING_MAP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "string.h"
+#include "simd.h"
+
+namespace nativa
+{
+	/// <summary>
+	/// A key passed to a string_map or a string_set.
+	/// Converts implicitly from a string, whose cached hash is then used,
+	/// a string_view, or a string literal, so that lookups never build strings.
+	/// </summary>
+	class string_key
+	{
+	public:
+		string_key(const nativa::string& key);
+
+		string_key(const nativa::string_view& key);
+
+		template <size_t N>
+		string_key(const char(&key)[N]);
+
+		// it may point into itself
+		string_key(const string_key&) = delete;
+
+		const nativa::string_view& view() const;
+
+		size_t hash() const;
+
+		/// <summary>
+		/// Gets a string to be stored: the same one, the literal, or a clone of the view.
+		/// </summary>
+		nativa::string to_string() const;
+
+	private:
+		nativa::string_view m_view;
+
+		size_t m_hash;
+
+		const nativa::string* m_shared;
+
+		nativa::string m_literal;
+	};
+
+	/// <summary>
+	/// The open addressing table under string_map and string_set.
+	/// Slots come in groups of 16, each with a control byte telling whether it is
+	/// empty, deleted, or full, in which case it holds 7 bits of the hash.
+	/// A lookup compares a group's control bytes at once, then the full stored
+	/// hashes of the candidates, and only then the keys.
+	/// </summary>
+	/// <typeparam name="Entry">What a slot holds</typeparam>
+	/// <typeparam name="KeyOf">Gets the nativa::string key of an entry</typeparam>
+	template <typename Entry, typename KeyOf>
+	class string_table
+	{
+	public:
+		template <bool Const>
+		class basic_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Entry;
+			using difference_type = ptrdiff_t;
+			using pointer = typename std::conditional<Const, const Entry*, Entry*>::type;
+			using reference = typename std::conditional<Const, const Entry&, Entry&>::type;
+
+			basic_iterator();
+
+			// a const iterator from a mutable one
+			template <bool OtherConst, typename = typename std::enable_if<Const && !OtherConst>::type>
+			basic_iterator(const basic_iterator<OtherConst>& another);
+
+			reference operator*() const;
+
+			pointer operator->() const;
+
+			basic_iterator& operator++();
+
+			basic_iterator operator++(int);
+
+			bool operator==(const basic_iterator& another) const;
+
+			bool operator!=(const basic_iterator& another) const;
+
+		private:
+			friend class string_table;
+
+			template <bool>
+			friend class basic_iterator;
+
+			const int8_t* m_control;
+
+			const int8_t* m_control_end;
+
+			typename string_table::slot* m_slot;
+
+			basic_iterator(const int8_t* control, const int8_t* control_end, typename string_table::slot* slot);
+
+			void skip_free();
+		};
+
+		using iterator = basic_iterator<false>;
+
+		using const_iterator = basic_iterator<true>;
+
+		string_table();
+
+		string_table(const string_table& another);
+
+		string_table(string_table&& another) noexcept;
+
+		~string_table() noexcept;
+
+		string_table& operator=(string_table another) noexcept;
+
+		size_t size() const;
+
+		bool is_empty() const;
+
+		/// <summary>
+		/// Makes room for the given number of entries without rehashing.
+		/// </summary>
+		void reserve(size_t count);
+
+		void clear();
+
+		iterator find(const string_key& key);
+
+		const_iterator find(const string_key& key) const;
+
+		bool contains(const string_key& key) const;
+
+		/// <summary>
+		/// Removes the entry with the given key.
+		/// </summary>
+		/// <returns>Whether there was such an entry</returns>
+		bool erase(const string_key& key);
+
+		iterator begin();
+
+		iterator end();
+
+		const_iterator begin() const;
+
+		const_iterator end() const;
+
+	protected:
+		/// <summary>
+		/// Finds the entry with the key, or makes one by calling make(where, key_string).
+		/// </summary>
+		/// <returns>The entry, and whether it has been made</returns>
+		template <typename Make>
+		std::pair<iterator, bool> find_or_make(const string_key& key, const Make& make);
+
+	private:
+		static constexpr size_t group_size = 16;
+
+		static constexpr int8_t empty = -128;
+
+		static constexpr int8_t deleted = -2;
+
+		struct slot
+		{
+			size_t hash;
+
+			alignas(Entry) unsigned char storage[sizeof(Entry)];
+
+			Entry& entry()
+			{
+				return *reinterpret_cast<Entry*>(storage);
+			}
+		};
+
+		/// <summary>
+		/// One byte per slot, negative if the slot is free
+		/// </summary>
+		int8_t* m_control;
+
+		slot* m_slots;
+
+		/// <summary>
+		/// A multiple of group_size and a power of 2, or 0 before the first insertion
+		/// </summary>
+		size_t m_capacity;
+
+		size_t m_size;
+
+		/// <summary>
+		/// How many empty slots may still be filled before the table is too full
+		/// </summary>
+		size_t m_growth_left;
+
+		static size_t group_of(size_t hash);
+
+		static int8_t tag_of(size_t hash);
+
+		static uint32_t match(const int8_t* group, int8_t tag);
+
+		static bool same_chars(const nativa::string_view& left, const nativa::string_view& right);
+
+		size_t find_index(const string_key& key) const;
+
+		void rehash(size_t capacity);
+
+		void destroy() noexcept;
+	};
+
+	struct string_map_key
+	{
+		template <typename Entry>
+		const nativa::string& operator()(const Entry& entry) const
+		{
+			return entry.first;
+		}
+	};
+
+	struct string_set_key
+	{
+		const nativa::string& operator()(const nativa::string& entry) const
+		{
+			return entry;
+		}
+	};
+
+	/// <summary>
+	/// A hash map from nativa::string keys, stored by sharing the strings,
+	/// to values of type V. Lookups take string_views, literals or strings
+	/// and never allocate. References to entries are invalidated by rehashing.
+	/// </summary>
+	template <typename V>
+	class string_map : public string_table<std::pair<const nativa::string, V>, string_map_key>
+	{
+		using base = string_table<std::pair<const nativa::string, V>, string_map_key>;
+
+	public:
+		using typename base::iterator;
+
+		using typename base::const_iterator;
+
+		/// <summary>
+		/// Inserts an entry with a value made from args if the key is not there.
+		/// The key is cloned only if it is a string_view and gets inserted.
+		/// </summary>
+		/// <returns>The entry with the key, and whether it has been inserted</returns>
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(const string_key& key, Args&&... args);
+
+		/// <summary>
+		/// Inserts or replaces the value of the key.
+		/// </summary>
+		/// <returns>Whether the key has been inserted</returns>
+		template <typename T>
+		bool insert_or_assign(const string_key& key, T&& value);
+
+		V& operator[](const string_key& key);
+
+		V& at(const string_key& key);
+
+		const V& at(const string_key& key) const;
+	};
+
+	/// <summary>
+	/// A hash set of nativa::strings, with the same lookups as string_map.
+	/// </summary>
+	class string_set : public string_table<const nativa::string, string_set_key>
+	{
+		using base = string_table<const nativa::string, string_set_key>;
+
+	public:
+		/// <summary>
+		/// Inserts the key if it is not there, cloning it only if it is a string_view.
+		/// </summary>
+		/// <returns>The string in the set, and whether it has been inserted</returns>
+		std::pair<iterator, bool> insert(const string_key& key);
+	};
+
+#pragma region Template and Inline Function Impl
+
+	inline string_key::string_key(const nativa::string& key)
+		: m_view(key.view()), m_hash(key.hash()), m_shared(&key)
+	{
+	}
+
+	inline string_key::string_key(const nativa::string_view& key)
+		: m_view(key), m_hash(std::hash<nativa::string_view>()(key)), m_shared(nullptr)
+	{
+	}
+
+	template <size_t N>
+	inline string_key::string_key(const char(&key)[N])
+		: m_view(key), m_hash(std::hash<nativa::string_view>()(m_view)), m_shared(&m_literal), m_literal(key)
+	{
+	}
+
+	inline const nativa::string_view& string_key::view() const
+	{
+		return m_view;
+	}
+
+	inline size_t string_key::hash() const
+	{
+		return m_hash;
+	}
+
+	inline nativa::string string_key::to_string() const
+	{
+		if (m_shared != nullptr) return *m_shared;
+		return m_view.clone();
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline size_t string_table<Entry, KeyOf>::group_of(size_t hash)
+	{
+		// std::hash of a string_view is weak in its low bits, so spread them first
+		uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(mixed ^ (mixed >> 32));
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline int8_t string_table<Entry, KeyOf>::tag_of(size_t hash)
+	{
+		uint64_t mixed = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+		return static_cast<int8_t>(mixed >> 57); // the top 7 bits, never negative
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline uint32_t string_table<Entry, KeyOf>::match(const int8_t* group, int8_t tag)
+	{
+#ifdef NATIVA_SIMD_SSE2
+		const __m128i control = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+		return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(tag))));
+#else
+		uint32_t res = 0;
+		for (size_t i = 0; i < group_size; ++i)
+		{
+			res |= static_cast<uint32_t>(group[i] == tag) << i;
+		}
+		return res;
+#endif
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline bool string_table<Entry, KeyOf>::same_chars(const nativa::string_view& left, const nativa::string_view& right)
+	{
+		return left.size() == right.size() && std::memcmp(left.begin(), right.begin(), left.size()) == 0;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline string_table<Entry, KeyOf>::string_table()
+		: m_control(nullptr), m_slots(nullptr), m_capacity(0), m_size(0), m_growth_left(0)
+	{
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline string_table<Entry, KeyOf>::string_table(const string_table& another)
+		: string_table()
+	{
+		reserve(another.m_size);
+		for (const auto& entry : another)
+		{
+			find_or_make(KeyOf()(entry), [&](void* where, const nativa::string&)
+			{
+				new (where) Entry(entry);
+			});
+		}
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline string_table<Entry, KeyOf>::string_table(string_table&& another) noexcept
+		: m_control(another.m_control), m_slots(another.m_slots), m_capacity(another.m_capacity),
+		m_size(another.m_size), m_growth_left(another.m_growth_left)
+	{
+		another.m_control = nullptr;
+		another.m_slots = nullptr;
+		another.m_capacity = 0;
+		another.m_size = 0;
+		another.m_growth_left = 0;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline string_table<Entry, KeyOf>::~string_table() noexcept
+	{
+		destroy();
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline string_table<Entry, KeyOf>& string_table<Entry, KeyOf>::operator=(string_table another) noexcept
+	{
+		std::swap(m_control, another.m_control);
+		std::swap(m_slots, another.m_slots);
+		std::swap(m_capacity, another.m_capacity);
+		std::swap(m_size, another.m_size);
+		std::swap(m_growth_left, another.m_growth_left);
+		return *this;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline size_t string_table<Entry, KeyOf>::size() const
+	{
+		return m_size;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline bool string_table<Entry, KeyOf>::is_empty() const
+	{
+		return m_size == 0;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline void string_table<Entry, KeyOf>::reserve(size_t count)
+	{
+		// at most 7 / 8 of the slots are used
+		size_t capacity = group_size;
+		while (capacity - capacity / 8 < count) capacity *= 2;
+		if (capacity > m_capacity) rehash(capacity);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline void string_table<Entry, KeyOf>::clear()
+	{
+		destroy();
+		m_control = nullptr;
+		m_slots = nullptr;
+		m_capacity = 0;
+		m_size = 0;
+		m_growth_left = 0;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline size_t string_table<Entry, KeyOf>::find_index(const string_key& key) const
+	{
+		if (m_size == 0) return m_capacity;
+
+		const size_t hash = key.hash();
+		const int8_t tag = tag_of(hash);
+		const size_t group_mask = m_capacity / group_size - 1;
+
+		// triangular probing visits every group once
+		size_t group = group_of(hash) & group_mask;
+		for (size_t step = 1;; ++step)
+		{
+			const int8_t* control = m_control + group * group_size;
+			uint32_t candidates = match(control, tag);
+			while (candidates != 0)
+			{
+				size_t index = group * group_size + simd::lowest_bit(candidates);
+				slot& candidate = m_slots[index];
+				if (candidate.hash == hash && same_chars(KeyOf()(candidate.entry()), key.view())) return index;
+				candidates &= candidates - 1;
+			}
+			if (match(control, empty) != 0) return m_capacity;
+
+			group = (group + step) & group_mask;
+		}
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::iterator string_table<Entry, KeyOf>::find(const string_key& key)
+	{
+		size_t index = find_index(key);
+		if (index == m_capacity) return end();
+		return iterator(m_control + index, m_control + m_capacity, m_slots + index);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::const_iterator string_table<Entry, KeyOf>::find(const string_key& key) const
+	{
+		size_t index = find_index(key);
+		if (index == m_capacity) return end();
+		return const_iterator(m_control + index, m_control + m_capacity, m_slots + index);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline bool string_table<Entry, KeyOf>::contains(const string_key& key) const
+	{
+		return find_index(key) != m_capacity;
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline bool string_table<Entry, KeyOf>::erase(const string_key& key)
+	{
+		size_t index = find_index(key);
+		if (index == m_capacity) return false;
+
+		m_slots[index].entry().~Entry();
+		m_size -= 1;
+
+		// a group with an empty slot ends every probe, so the slot may become empty again
+		size_t group_begin = index / group_size * group_size;
+		if (match(m_control + group_begin, empty) != 0)
+		{
+			m_control[index] = empty;
+			m_growth_left += 1;
+		}
+		else
+		{
+			m_control[index] = deleted;
+		}
+		return true;
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <typename Make>
+	inline std::pair<typename string_table<Entry, KeyOf>::iterator, bool>
+		string_table<Entry, KeyOf>::find_or_make(const string_key& key, const Make& make)
+	{
+		size_t found = find_index(key);
+		if (found != m_capacity)
+		{
+			return { iterator(m_control + found, m_control + m_capacity, m_slots + found), false };
+		}
+
+		if (m_growth_left == 0)
+		{
+			// when mostly deleted slots fill the table, cleaning them up is enough
+			if (m_capacity == 0) rehash(group_size);
+			else rehash(m_size >= m_capacity / 2 ? m_capacity * 2 : m_capacity);
+		}
+
+		const size_t hash = key.hash();
+		const size_t group_mask = m_capacity / group_size - 1;
+		size_t group = group_of(hash) & group_mask;
+		for (size_t step = 1;; ++step)
+		{
+			const int8_t* control = m_control + group * group_size;
+			uint32_t free = match(control, empty) | match(control, deleted);
+			if (free != 0)
+			{
+				size_t index = group * group_size + simd::lowest_bit(free);
+				slot& target = m_slots[index];
+				make(static_cast<void*>(target.storage), key.to_string());
+				target.hash = hash;
+				if (m_control[index] == empty) m_growth_left -= 1;
+				m_control[index] = tag_of(hash);
+				m_size += 1;
+				return { iterator(m_control + index, m_control + m_capacity, m_slots + index), true };
+			}
+
+			group = (group + step) & group_mask;
+		}
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline void string_table<Entry, KeyOf>::rehash(size_t capacity)
+	{
+		int8_t* old_control = m_control;
+		slot* old_slots = m_slots;
+		size_t old_capacity = m_capacity;
+
+		// aligned for the group loads
+		m_control = static_cast<int8_t*>(::operator new(capacity, std::align_val_t(group_size)));
+		std::memset(m_control, empty, capacity);
+		m_slots = static_cast<slot*>(::operator new(capacity * sizeof(slot), std::align_val_t(alignof(slot))));
+		m_capacity = capacity;
+		m_growth_left = capacity - capacity / 8;
+
+		// the stored hashes save hashing the keys again
+		const size_t group_mask = capacity / group_size - 1;
+		for (size_t i = 0; i < old_capacity; ++i)
+		{
+			if (old_control[i] < 0) continue;
+
+			slot& from = old_slots[i];
+			size_t group = group_of(from.hash) & group_mask;
+			for (size_t step = 1;; ++step)
+			{
+				uint32_t free = match(m_control + group * group_size, empty);
+				if (free != 0)
+				{
+					size_t index = group * group_size + simd::lowest_bit(free);
+					slot& to = m_slots[index];
+					new (to.storage) Entry(std::move(from.entry()));
+					to.hash = from.hash;
+					from.entry().~Entry();
+					m_control[index] = tag_of(from.hash);
+					m_growth_left -= 1;
+					break;
+				}
+				group = (group + step) & group_mask;
+			}
+		}
+
+		if (old_capacity != 0)
+		{
+			::operator delete(old_control, std::align_val_t(group_size));
+			::operator delete(old_slots, std::align_val_t(alignof(slot)));
+		}
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline void string_table<Entry, KeyOf>::destroy() noexcept
+	{
+		if (m_capacity == 0) return;
+
+		for (size_t i = 0; i < m_capacity; ++i)
+		{
+			if (m_control[i] >= 0) m_slots[i].entry().~Entry();
+		}
+		::operator delete(m_control, std::align_val_t(group_size));
+		::operator delete(m_slots, std::align_val_t(alignof(slot)));
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::iterator string_table<Entry, KeyOf>::begin()
+	{
+		return iterator(m_control, m_control + m_capacity, m_slots);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::iterator string_table<Entry, KeyOf>::end()
+	{
+		return iterator(m_control + m_capacity, m_control + m_capacity, m_slots + m_capacity);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::const_iterator string_table<Entry, KeyOf>::begin() const
+	{
+		return const_iterator(m_control, m_control + m_capacity, m_slots);
+	}
+
+	template <typename Entry, typename KeyOf>
+	inline typename string_table<Entry, KeyOf>::const_iterator string_table<Entry, KeyOf>::end() const
+	{
+		return const_iterator(m_control + m_capacity, m_control + m_capacity, m_slots + m_capacity);
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline string_table<Entry, KeyOf>::basic_iterator<Const>::basic_iterator()
+		: m_control(nullptr), m_control_end(nullptr), m_slot(nullptr)
+	{
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	template <bool OtherConst, typename>
+	inline string_table<Entry, KeyOf>::basic_iterator<Const>::basic_iterator(const basic_iterator<OtherConst>& another)
+		: m_control(another.m_control), m_control_end(another.m_control_end), m_slot(another.m_slot)
+	{
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline string_table<Entry, KeyOf>::basic_iterator<Const>::basic_iterator(
+		const int8_t* control, const int8_t* control_end, typename string_table::slot* slot)
+		: m_control(control), m_control_end(control_end), m_slot(slot)
+	{
+		skip_free();
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline void string_table<Entry, KeyOf>::basic_iterator<Const>::skip_free()
+	{
+		while (m_control != m_control_end && *m_control < 0)
+		{
+			++m_control;
+			++m_slot;
+		}
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline typename string_table<Entry, KeyOf>::template basic_iterator<Const>::reference
+		string_table<Entry, KeyOf>::basic_iterator<Const>::operator*() const
+	{
+		return m_slot->entry();
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline typename string_table<Entry, KeyOf>::template basic_iterator<Const>::pointer
+		string_table<Entry, KeyOf>::basic_iterator<Const>::operator->() const
+	{
+		return &m_slot->entry();
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline typename string_table<Entry, KeyOf>::template basic_iterator<Const>&
+		string_table<Entry, KeyOf>::basic_iterator<Const>::operator++()
+	{
+		++m_control;
+		++m_slot;
+		skip_free();
+		return *this;
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline typename string_table<Entry, KeyOf>::template basic_iterator<Const>
+		string_table<Entry, KeyOf>::basic_iterator<Const>::operator++(int)
+	{
+		basic_iterator temp = *this;
+		this->operator++();
+		return temp;
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline bool string_table<Entry, KeyOf>::basic_iterator<Const>::operator==(const basic_iterator& another) const
+	{
+		return m_control == another.m_control;
+	}
+
+	template <typename Entry, typename KeyOf>
+	template <bool Const>
+	inline bool string_table<Entry, KeyOf>::basic_iterator<Const>::operator!=(const basic_iterator& another) const
+	{
+		return m_control != another.m_control;
+	}
+
+	template <typename V>
+	template <typename... Args>
+	inline std::pair<typename string_map<V>::iterator, bool> string_map<V>::try_emplace(const string_key& key, Args&&... args)
+	{
+		return this->find_or_make(key, [&](void* where, nativa::string&& stored)
+		{
+			new (where) std::pair<const nativa::string, V>(
+				std::piecewise_construct,
+				std::forward_as_tuple(std::move(stored)),
+				std::forward_as_tuple(std::forward<Args>(args)...));
+		});
+	}
+
+	template <typename V>
+	template <typename T>
+	inline bool string_map<V>::insert_or_assign(const string_key& key, T&& value)
+	{
+		auto res = try_emplace(key, std::forward<T>(value));
+		if (!res.second) res.first->second = std::forward<T>(value);
+		return res.second;
+	}
+
+	template <typename V>
+	inline V& string_map<V>::operator[](const string_key& key)
+	{
+		return try_emplace(key).first->second;
+	}
+
+	template <typename V>
+	inline V& string_map<V>::at(const string_key& key)
+	{
+		auto it = this->find(key);
+		assert(it != this->end());
+		return it->second;
+	}
+
+	template <typename V>
+	inline const V& string_map<V>::at(const string_key& key) const
+	{
+		auto it = this->find(key);
+		assert(it != this->end());
+		return it->second;
+	}
+
+	inline std::pair<string_set::iterator, bool> string_set::insert(const string_key& key)
+	{
+		return find_or_make(key, [](void* where, nativa::string&& stored)
+		{
+			new (where) nativa::string(std::move(stored));
+		});
+	}
+
+#pragma endregion
+}
+
+#endif
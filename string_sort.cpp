@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include "string_sort.h"
+
+namespace nativa
+{
+	namespace sort_internal
+	{
+		namespace
+		{
+			// string_view compares chars as char;
+			// where char is signed, flipping the sign bit makes unsigned comparisons agree
+			const uint8_t flip = std::is_signed<char>::value ? 0x80 : 0;
+
+			const size_t insertion_threshold = 24;
+
+			// below this one thread sorts faster than several start
+			const size_t parallel_threshold = size_t(1) << 16;
+
+			inline size_t remaining(const item& it, size_t depth)
+			{
+				return depth >= it.size ? 0 : it.size - depth;
+			}
+
+			/// <summary>
+			/// Packs the 8 chars from depth on into an integer comparing like them,
+			/// padded with zeros past the end.
+			/// </summary>
+			inline uint64_t key_at(const item& it, size_t depth)
+			{
+				size_t count = remaining(it, depth);
+				if (count > 8) count = 8;
+
+				unsigned char bytes[8] = {};
+				if (count != 0) std::memcpy(bytes, it.begin + depth, count);
+
+				// only the real chars are flipped, the padding stays below them all
+				uint64_t res = 0;
+				for (size_t i = 0; i < 8; ++i)
+				{
+					res = (res << 8) | (i < count ? bytes[i] ^ flip : 0);
+				}
+				return res;
+			}
+
+			inline void load_keys(item* items, size_t count, size_t depth)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					items[i].key = key_at(items[i], depth);
+				}
+			}
+
+			/// <summary>
+			/// Compares two items known to be equal before depth, their keys loaded at depth.
+			/// Equal keys mean equal chars, except that a shorter string has zeros as padding,
+			/// so once either has no more than 8 chars left it is a prefix of the other.
+			/// </summary>
+			inline bool less_from(const item& left, const item& right, size_t depth)
+			{
+				uint64_t l_key = left.key;
+				uint64_t r_key = right.key;
+				for (;;)
+				{
+					if (l_key != r_key) return l_key < r_key;
+
+					size_t l_left = remaining(left, depth);
+					size_t r_left = remaining(right, depth);
+					if (l_left <= 8 || r_left <= 8) return l_left < r_left;
+
+					depth += 8;
+					l_key = key_at(left, depth);
+					r_key = key_at(right, depth);
+				}
+			}
+
+			// stable, as it only moves an item past strictly greater ones
+			void insertion_sort(item* items, size_t count, size_t depth)
+			{
+				for (size_t i = 1; i < count; ++i)
+				{
+					item current = items[i];
+					size_t j = i;
+					while (j > 0 && less_from(current, items[j - 1], depth))
+					{
+						items[j] = items[j - 1];
+						--j;
+					}
+					items[j] = current;
+				}
+			}
+
+			inline uint64_t median_of_three(uint64_t a, uint64_t b, uint64_t c)
+			{
+				if (a < b)
+				{
+					if (b < c) return b;
+					return a < c ? c : a;
+				}
+				if (a < c) return a;
+				return b < c ? c : b;
+			}
+
+			/// <summary>
+			/// Sorts items equal before depth, their keys loaded at depth.
+			/// </summary>
+			void multikey_quicksort(item* items, size_t count, size_t depth)
+			{
+				for (;;)
+				{
+					if (count <= insertion_threshold)
+					{
+						insertion_sort(items, count, depth);
+						return;
+					}
+
+					const uint64_t pivot = median_of_three(
+						items[0].key, items[count / 2].key, items[count - 1].key);
+
+					// [0, less) < pivot, [less, greater) == pivot, [greater, count) > pivot
+					size_t less = 0;
+					size_t greater = count;
+					for (size_t i = 0; i < greater;)
+					{
+						const uint64_t key = items[i].key;
+						if (key < pivot) std::swap(items[less++], items[i++]);
+						else if (key > pivot) std::swap(items[i], items[--greater]);
+						else ++i;
+					}
+
+					multikey_quicksort(items, less, depth);
+					multikey_quicksort(items + greater, count - greater, depth);
+
+					// the strings ending within the key are prefixes of the rest,
+					// and of each other by their lengths
+					item* equal = items + less;
+					item* equal_end = items + greater;
+					item* unfinished = std::partition(equal, equal_end, [depth](const item& it)
+					{
+						return remaining(it, depth) <= 8;
+					});
+					std::sort(equal, unfinished, [depth](const item& left, const item& right)
+					{
+						return remaining(left, depth) < remaining(right, depth);
+					});
+
+					// the rest is sorted by the next 8 chars, without recursion
+					items = unfinished;
+					count = static_cast<size_t>(equal_end - unfinished);
+					depth += 8;
+					load_keys(items, count, depth);
+				}
+			}
+
+			inline size_t bucket_of(const item& it, size_t depth)
+			{
+				// 0 for the strings ending before depth, which come first
+				return depth < it.size ? (static_cast<uint8_t>(it.begin[depth]) ^ flip) + 1 : 0;
+			}
+
+			/// <summary>
+			/// Stably distributes the items into 257 buckets by the char at depth.
+			/// </summary>
+			/// <returns>false if they are all in the same bucket, in which case nothing is moved</returns>
+			bool distribute(item* items, item* aux, size_t count, size_t depth, size_t(&offsets)[258])
+			{
+				size_t counts[257] = {};
+				for (size_t i = 0; i < count; ++i)
+				{
+					counts[bucket_of(items[i], depth)] += 1;
+				}
+
+				offsets[0] = 0;
+				for (size_t b = 0; b < 257; ++b)
+				{
+					if (counts[b] == count) return false;
+					offsets[b + 1] = offsets[b] + counts[b];
+				}
+
+				size_t next[257];
+				std::copy(offsets, offsets + 257, next);
+				for (size_t i = 0; i < count; ++i)
+				{
+					aux[next[bucket_of(items[i], depth)]++] = items[i];
+				}
+				std::copy(aux, aux + count, items);
+				return true;
+			}
+
+			/// <summary>
+			/// Stably sorts items equal before depth.
+			/// </summary>
+			void radix_sort(item* items, item* aux, size_t count, size_t depth)
+			{
+				for (;;)
+				{
+					if (count <= insertion_threshold)
+					{
+						load_keys(items, count, depth);
+						insertion_sort(items, count, depth);
+						return;
+					}
+
+					size_t offsets[258];
+					if (distribute(items, aux, count, depth, offsets))
+					{
+						// the largest bucket is sorted by the loop, the others by recursion,
+						// so each call has at most half the items of its caller and the depth stays logarithmic
+						size_t largest = 1;
+						for (size_t b = 2; b < 257; ++b)
+						{
+							if (offsets[b + 1] - offsets[b] > offsets[largest + 1] - offsets[largest]) largest = b;
+						}
+						for (size_t b = 1; b < 257; ++b)
+						{
+							size_t size = offsets[b + 1] - offsets[b];
+							if (b != largest && size > 1) radix_sort(items + offsets[b], aux + offsets[b], size, depth + 1);
+						}
+
+						count = offsets[largest + 1] - offsets[largest];
+						items += offsets[largest];
+						aux += offsets[largest];
+						depth += 1;
+						if (count <= 1) return;
+						continue;
+					}
+
+					// a common char, nothing to do but looking further
+					if (depth >= items[0].size) return; // all ended, all equal
+					depth += 1;
+				}
+			}
+
+			void sort_part(item* items, item* aux, size_t count, size_t depth, bool stable)
+			{
+				if (stable)
+				{
+					radix_sort(items, aux, count, depth);
+				}
+				else
+				{
+					load_keys(items, count, depth);
+					multikey_quicksort(items, count, depth);
+				}
+			}
+		}
+
+		void sort_items(item* items, size_t count, bool stable, size_t threads)
+		{
+			if (threads == 0) threads = std::thread::hardware_concurrency();
+			std::vector<item> aux(stable || threads > 1 ? count : 0);
+
+			if (threads <= 1 || count < parallel_threshold)
+			{
+				sort_part(items, aux.data(), count, 0, stable);
+				return;
+			}
+
+			// distribute by the first char, then hand out the buckets, the largest first
+			size_t offsets[258];
+			if (!distribute(items, aux.data(), count, 0, offsets))
+			{
+				sort_part(items, aux.data(), count, 0, stable);
+				return;
+			}
+
+			std::vector<std::pair<size_t, size_t>> buckets; // offset, size
+			for (size_t b = 1; b < 257; ++b)
+			{
+				size_t size = offsets[b + 1] - offsets[b];
+				if (size > 1) buckets.emplace_back(offsets[b], size);
+			}
+			std::sort(buckets.begin(), buckets.end(), [](const std::pair<size_t, size_t>& left, const std::pair<size_t, size_t>& right)
+			{
+				return left.second > right.second;
+			});
+
+			std::atomic<size_t> next{ 0 };
+			auto work = [&]
+			{
+				for (;;)
+				{
+					size_t taken = next.fetch_add(1);
+					if (taken >= buckets.size()) return;
+					const auto& bucket = buckets[taken];
+					sort_part(items + bucket.first, aux.data() + bucket.first, bucket.second, 1, stable);
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (size_t i = 1; i < threads && i < buckets.size(); ++i)
+			{
+				workers.emplace_back(work);
+			}
+			work();
+			for (auto& worker : workers) worker.join();
+		}
+	}
+}
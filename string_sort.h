@@ -0,0 +1,119 @@
+#pragma once
+#ifndef NATIVA_STRING_SORT
+#define NATIVA_STRING_SORT
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "string_view.h"
+
+namespace nativa
+{
+	namespace sort_internal
+	{
+		/// <summary>
+		/// What the sorts work on: the chars of an element, where it comes from,
+		/// and the 8 chars at the current depth packed in an integer, so that most
+		/// comparisons touch neither the chars nor the element.
+		/// </summary>
+		struct item
+		{
+			uint64_t key;
+			const char* begin;
+			size_t size;
+			size_t index;
+		};
+
+		void sort_items(item* items, size_t count, bool stable, size_t threads);
+
+		template <typename RandomIt>
+		void sort(RandomIt first, RandomIt last, bool stable, size_t threads);
+	}
+
+	/// <summary>
+	/// Sorts elements convertible to string_view in the order of string_view::operator&lt;.
+	/// A multikey quicksort comparing 8 chars at a time, which unlike std::sort
+	/// never compares a common prefix more than once.
+	/// </summary>
+	template <typename RandomIt>
+	void sort_strings(RandomIt first, RandomIt last);
+
+	/// <summary>
+	/// Same as sort_strings, but keeps the order of equal elements,
+	/// by a most significant digit first radix sort.
+	/// </summary>
+	template <typename RandomIt>
+	void stable_sort_strings(RandomIt first, RandomIt last);
+
+	/// <summary>
+	/// Same as sort_strings or stable_sort_strings, but once the elements are
+	/// distributed by their first char the parts are sorted on several threads.
+	/// </summary>
+	/// <param name="threads">How many threads may be used, 0 for one per hardware thread</param>
+	template <typename RandomIt>
+	void parallel_sort_strings(RandomIt first, RandomIt last, bool stable = false, size_t threads = 0);
+
+#pragma region Template Function Impl
+
+	template <typename RandomIt>
+	inline void sort_internal::sort(RandomIt first, RandomIt last, bool stable, size_t threads)
+	{
+		using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+		const size_t count = static_cast<size_t>(last - first);
+		if (count < 2) return;
+
+		std::vector<item> items(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const nativa::string_view& view = first[i];
+			items[i] = item{ 0, view.begin(), view.size(), i };
+		}
+
+		sort_items(items.data(), count, stable, threads);
+
+		// the elements are put in place by walking the cycles of the permutation,
+		// so each is moved once, plus once more for the first of each cycle
+		for (size_t start = 0; start < count; ++start)
+		{
+			if (items[start].index == start) continue;
+
+			value_type held = std::move(first[start]);
+			size_t at = start;
+			while (items[at].index != start)
+			{
+				const size_t from = items[at].index;
+				first[at] = std::move(first[from]);
+				items[at].index = at;
+				at = from;
+			}
+			first[at] = std::move(held);
+			items[at].index = at;
+		}
+	}
+
+	template <typename RandomIt>
+	inline void sort_strings(RandomIt first, RandomIt last)
+	{
+		sort_internal::sort(first, last, false, 1);
+	}
+
+	template <typename RandomIt>
+	inline void stable_sort_strings(RandomIt first, RandomIt last)
+	{
+		sort_internal::sort(first, last, true, 1);
+	}
+
+	template <typename RandomIt>
+	inline void parallel_sort_strings(RandomIt first, RandomIt last, bool stable, size_t threads)
+	{
+		sort_internal::sort(first, last, stable, threads);
+	}
+
+#pragma endregion
+}
+
+#endif
@@ -1,69 +1,44 @@
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include "string_view.h"
 #include "string.h"  // implementation of string_view::clone relies on this
+#include "simd.h"
+#include "instrumentation.h"
 
 namespace nativa
 {
-	int nativa::string_view::compare_to(const string_view& another) const
+	int string_view::compare_runtime(const string_view& another) const
 	{
-		auto lp = this->m_begin;
-		auto rp = another.m_begin;
-		for (;;)
-		{
-			if (lp == this->m_end)
-			{
-				if (rp == another.m_end)
-				{
-					return 0;
-				}
-
-				return -1;
-			}
-
-			if (rp == this->m_end)
-			{
-				return 1;
-			}
-
-			const char l = *lp;
-			const char r = *rp;
-			if (l < r) return -1;
-			else if (l > r) return 1;
+		const size_t l_size = this->size();
+		const size_t r_size = another.size();
+		const size_t common = l_size < r_size ? l_size : r_size;
 
-			++lp;
-			++rp;
+		// skip equal blocks and words, then find the first different char, compared as char
+		size_t i = 0;
+		while (i + 64 <= common && std::memcmp(m_begin + i, another.m_begin + i, 64) == 0) i += 64;
+		for (; i + 8 <= common; i += 8)
+		{
+			uint64_t l_word, r_word;
+			std::memcpy(&l_word, m_begin + i, 8);
+			std::memcpy(&r_word, another.m_begin + i, 8);
+			if (l_word != r_word) break;
+		}
+		for (; i < common; ++i)
+		{
+			const char l = m_begin[i];
+			const char r = another.m_begin[i];
+			if (l != r) return l < r ? -1 : 1;
 		}
-	}
-
-	ptrdiff_t string_view::last_index_of(char target) const
-	{
-		return find_last(target, m_end) - m_begin;
-	}
-
-	ptrdiff_t string_view::last_index_of(char target, size_t before) const
-	{
-		assert(before < size());
-
-		return find_last(target, m_begin + before) - m_begin;
-	}
-
-	ptrdiff_t string_view::index_of(const char target, size_t since) const
-	{
-		auto res = find(target, m_begin + since);
-		if (res == m_end) return -1;
-		return res - m_begin;
-	}
 
-	ptrdiff_t string_view::index_of(const string_view& target, size_t since) const
-	{
-		auto res = find(target, m_begin + since);
-		if (res == m_end) return -1;
-		return res - m_begin;
+		if (l_size == r_size) return 0;
+		return l_size < r_size ? -1 : 1;
 	}
 
 	nativa::string string_view::clone() const
 	{
+		NATIVA_COUNT(clones);
 		size_t size = this->size();
 		if (size == 0) return string("");
 		char* mutable_raw;
@@ -72,133 +47,98 @@ namespace nativa
 		return std::move(res);
 	}
 
-	nativa::string_view string_view::slice(size_t begin, size_t length) const
-	{
-		assert(m_begin + begin + length <= m_end);
-		return nativa::string_view(m_begin + begin, m_begin + begin + length);
-	}
-
-	void string_view::copy_to(char* buffer) const
-	{
-		std::copy(m_begin, m_end, buffer);
-	}
-
-	const char* string_view::begin() const
-	{
-		return m_begin;
-	}
-
-	const char* string_view::end() const
-	{
-		return m_end;
-	}
-
-	size_t string_view::size() const
-	{
-		return m_end - m_begin;
-	}
-
-	bool string_view::operator<(const string_view& right) const
-	{
-		return this->compare_to(right) < 0;
-	}
-
-	bool string_view::operator<=(const string_view& right) const
+	nativa::string string_view::replace(const string_view& from, const string_view& to) const
 	{
-		return *this < right || *this == right;
+		assert(!from.is_empty());
+		const char* first = find(from, m_begin);
+		if (first == m_end) return clone();
+		return replace_from(first, from, to, 1);
 	}
 
-	bool string_view::operator==(const string_view& right) const
+	nativa::string string_view::replace_all(const string_view& from, const string_view& to) const
 	{
-		return this->compare_to(right) == 0;
+		assert(!from.is_empty());
+		const char* first = find(from, m_begin);
+		if (first == m_end) return clone();
+		return replace_from(first, from, to, static_cast<size_t>(-1));
 	}
 
-	bool string_view::operator>=(const string_view& right) const
+	nativa::string string_view::replace_from(const char* first, const string_view& from, const string_view& to, size_t max_count) const
 	{
-		return *this > right || *this == right;
-	}
+		const size_t from_size = from.size();
+		const size_t to_size = to.size();
 
-	bool string_view::operator>(const string_view& right) const
-	{
-		return this->compare_to(right) > 0;
-	}
+		// counted before searching on, so that replace stops at its first match
+		size_t count = 0;
+		for (const char* it = first; it != m_end; it = find(from, it + from_size))
+		{
+			if (++count == max_count) break;
+		}
 
-	nativa::string_view string_view::operator[](const std::pair<size_t, size_t>& range) const
-	{
-		if (range.first == range.second) return "";
-		assert(range.first < this->size());
-		assert(range.second <= this->size());
-		return string_view(m_begin + range.first, m_begin + range.second);
-	}
+		const size_t new_size = size() - count * from_size + count * to_size;
+		if (new_size == 0) return string("");
 
-	bool string_view::is_empty() const
-	{
-		return size() == 0;
-	}
-
-	bool string_view::starts_with(const string_view& pattern) const
-	{
-		size_t p_size = pattern.size();
-		if (p_size > this->size()) return false;
-		return this->slice(0, p_size) == pattern;
-	}
-
-	bool string_view::ends_with(const string_view& pattern) const
-	{
-		size_t m_size = this->size();
-		size_t p_size = pattern.size();
-		if (p_size > m_size) return false;
-		return this->slice(m_size - p_size, p_size) == pattern;
-	}
+		char* mutable_raw;
+		auto res = string_internals::alloc(new_size, mutable_raw);
 
-	bool string_view::contains(const string_view& pattern) const
-	{
-		return find(pattern, m_begin) != m_end;
+		// the prefix before the first match is copied without searching again
+		const char* copied = m_begin;
+		const char* match = first;
+		for (size_t i = 0; i < count; ++i)
+		{
+			mutable_raw = std::copy(copied, match, mutable_raw);
+			mutable_raw = std::copy(to.m_begin, to.m_end, mutable_raw);
+			copied = match + from_size;
+			if (i + 1 < count) match = find(from, copied);
+		}
+		std::copy(copied, m_end, mutable_raw);
+		return std::move(res);
 	}
 
-	string_view::string_view(const char* begin, const char* end) noexcept
-		: m_begin(begin), m_end(end)
+	void string_view::copy_to(char* buffer) const
 	{
+		std::copy(m_begin, m_end, buffer);
 	}
 
-	const char* string_view::find_last(char target, const char* before) const
+	const char* string_view::find_runtime(const char target, const char* since) const
 	{
-		assert(before != nullptr);
-
-		while (before >= m_begin && target != *before) --before;
-		return before;
+		// the C library ships a vectorized one on every platform we care about
+		auto res = std::memchr(since, target, m_end - since);
+		return res == nullptr ? m_end : static_cast<const char*>(res);
 	}
 
-	const char* string_view::find(const char target, const char* since) const
+	const char* string_view::find_runtime(const string_view& target, const char* since) const
 	{
-		assert(since != nullptr);
+		const size_t t_size = target.size();
+		if (t_size == 0) return since;
+		if (static_cast<size_t>(m_end - since) < t_size) return m_end;
+		if (t_size == 1) return find_runtime(*target.m_begin, since);
 
-		while (since != m_end && target != *since) ++since;
-		return since;
-	}
-
-	const char* string_view::find(const string_view& target, const char* since) const
-	{
-		assert(since != nullptr);
+		const char* const last_start = m_end - t_size;
+		const char* it = since;
 
-		// TO-DO: optimize
-		auto end = m_end - target.size();
-		for (auto m_it = since; m_it <= end; ++m_it)
+#ifdef NATIVA_SIMD_SSE2
+		// filter candidates by their first and last chars, 16 positions a time
+		const __m128i first = _mm_set1_epi8(target.m_begin[0]);
+		const __m128i last = _mm_set1_epi8(target.m_begin[t_size - 1]);
+		for (; last_start - it >= 15; it += 16)
 		{
-			auto w_it = m_it;
-			auto t_it = target.m_begin;
-			while (*w_it == *t_it)
+			const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+			const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + t_size - 1));
+			uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+			while (candidates != 0)
 			{
-				++w_it;
-				++t_it;
-				if (t_it == target.m_end) return m_it;
+				const char* at = it + simd::lowest_bit(candidates);
+				if (std::memcmp(at + 1, target.m_begin + 1, t_size - 2) == 0) return at;
+				candidates &= candidates - 1;
 			}
 		}
+#endif
+		for (; it <= last_start; ++it)
+		{
+			if (*it == *target.m_begin && std::memcmp(it, target.m_begin, t_size) == 0) return it;
+		}
 		return m_end;
 	}
 }
-
-nativa::string_view operator""_ns(const char* c_str, size_t len)
-{
-	return nativa::string_view(c_str, c_str + len);
-}
\ No newline at end of file
@@ -2,14 +2,23 @@
 #ifndef NATIVA_STRING_VIEW
 #define NATIVA_STRING_VIEW
 
+#include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <functional>
+#include <iterator>
+#include <type_traits>
 #include <utility>
 
 namespace nativa
 {
 	class string;
 
+	class char_set;
+
+	template <typename Delimiter>
+	class splitter;
+
 	constexpr const char* c_str_end(const char* c_str);
 
 	/// <summary>
@@ -26,17 +35,23 @@ namespace nativa
 
 		constexpr string_view();
 
-		string_view(const char* begin, const char* end) noexcept;
+		constexpr string_view(const char* begin, const char* end) noexcept;
+
+		// The read-only operations below are constexpr, so they fold over literals.
+		// At runtime the searches and comparisons dispatch to the kernels in string_view.cpp.
 
-		int compare_to(const string_view& another) const;
+		constexpr int compare_to(const string_view& another) const;
 
-		ptrdiff_t last_index_of(char target) const;
+		constexpr ptrdiff_t last_index_of(char target) const;
 
-		ptrdiff_t last_index_of(char target, size_t before) const;
+		/// <summary>
+		/// Finds the last target at or before the given index.
+		/// </summary>
+		constexpr ptrdiff_t last_index_of(char target, size_t before) const;
 
-		ptrdiff_t index_of(char target, size_t from = 0) const;
+		constexpr ptrdiff_t index_of(char target, size_t from = 0) const;
 
-		ptrdiff_t index_of(const string_view& target, size_t from = 0) const;
+		constexpr ptrdiff_t index_of(const string_view& target, size_t from = 0) const;
 
 		/// <summary>
 		/// Split the string_view into substrings by the given delimiter.
@@ -74,19 +89,59 @@ namespace nativa
 		template <typename InsertIt>
 		void split(char delim, InsertIt output) const;
 
+		/// <summary>
+		/// Lazily splits the string_view into slices by the given delimiter.
+		/// Nothing is searched until the range is iterated, and iterating never allocates.
+		/// The range refers to the string_view's chars, which must outlive it.
+		/// </summary>
+		/// <param name="delim">The delimiter char</param>
+		/// <param name="max_splits">At most this many splits are done, the rest of the string_view being the last slice</param>
+		/// <param name="skip_empty">Whether empty slices are dropped; they do not count as splits</param>
+		/// <returns>A forward range of string_views</returns>
+		splitter<char> split_range(char delim, size_t max_splits = static_cast<size_t>(-1), bool skip_empty = false) const;
+
+		/// <summary>
+		/// Same as split_range(char, ...), but splits by a non-empty string_view.
+		/// </summary>
+		splitter<string_view> split_range(const string_view& delim, size_t max_splits = static_cast<size_t>(-1), bool skip_empty = false) const;
+
+		/// <summary>
+		/// Same as split_range(char, ...), but splits by any char in the set.
+		/// Defined in char_set.h.
+		/// </summary>
+		splitter<char_set> split_range(const char_set& delims, size_t max_splits = static_cast<size_t>(-1), bool skip_empty = false) const;
+
 		/// <summary>
 		/// Creates a string owning a clone of the view.
 		/// </summary>
 		/// <returns>A string that owns a clone of the view</returns>
 		nativa::string clone() const;
 
+		/// <summary>
+		/// Replaces the first occurrence of a string_view.
+		/// </summary>
+		/// <param name="from">The non-empty string_view to be replaced</param>
+		/// <param name="to">The replacement</param>
+		/// <returns>A new string, which is a clone when nothing is replaced</returns>
+		nativa::string replace(const string_view& from, const string_view& to) const;
+
+		/// <summary>
+		/// Replaces every non-overlapping occurrence of a string_view, from left to right.
+		/// The matches are counted before anything is copied,
+		/// so that the result is allocated once at its exact size.
+		/// </summary>
+		/// <param name="from">The non-empty string_view to be replaced</param>
+		/// <param name="to">The replacement</param>
+		/// <returns>A new string, which is a clone when nothing is replaced</returns>
+		nativa::string replace_all(const string_view& from, const string_view& to) const;
+
 		/// <summary>
 		/// Creates a slice with given begin index and length.
 		/// </summary>
 		/// <param name="begin">The begin index of the slice</param>
 		/// <param name="length">The length of the slice</param>
 		/// <returns>The expected slice</returns>
-		nativa::string_view slice(size_t begin, size_t length) const;
+		constexpr nativa::string_view slice(size_t begin, size_t length) const;
 
 		/// <summary>
 		/// Copies the data of the string_view to a buffer
@@ -94,23 +149,23 @@ namespace nativa
 		/// <param name="buffer">A pointer to the buffer, make sure it has enough space</param>
 		void copy_to(char* buffer) const;
 
-		const char* begin() const;
+		constexpr const char* begin() const;
 
-		const char* end() const;
+		constexpr const char* end() const;
 
-		size_t size() const;
+		constexpr size_t size() const;
 
-		bool operator<(const string_view& right) const;
+		constexpr bool operator<(const string_view& right) const;
 
-		bool operator<=(const string_view& right) const;
+		constexpr bool operator<=(const string_view& right) const;
 
-		bool operator==(const string_view& right) const;
+		constexpr bool operator==(const string_view& right) const;
 
-		bool operator>=(const string_view& right) const;
+		constexpr bool operator>=(const string_view& right) const;
 
-		bool operator>(const string_view& right) const;
+		constexpr bool operator>(const string_view& right) const;
 
-		bool operator!=(const string_view& right) const
+		constexpr bool operator!=(const string_view& right) const
 		{
 			return !this->operator==(right);
 		}
@@ -120,7 +175,7 @@ namespace nativa
 		/// </summary>
 		/// <param name="range">An std::pair representing the range, right exclusive</param>
 		/// <returns>The expected slice</returns>
-		nativa::string_view operator[](const std::pair<size_t, size_t>& range) const;
+		constexpr nativa::string_view operator[](const std::pair<size_t, size_t>& range) const;
 
 		/// <summary>
 		/// Gets an enumerable treating the string as the given encoding
@@ -133,25 +188,81 @@ namespace nativa
 		template <typename Encoding>
 		size_t length() const;
 
-		bool is_empty() const;
+		constexpr bool is_empty() const;
+
+		constexpr bool starts_with(const string_view& pattern) const;
+
+		constexpr bool ends_with(const string_view& pattern) const;
+
+		constexpr bool contains(const string_view& pattern) const;
+
+		/// <summary>
+		/// Finds the first char in the set.
+		/// Defined in char_set.cpp, as are the rest taking a char_set.
+		/// </summary>
+		/// <param name="chars">The set of chars to look for</param>
+		/// <param name="from">The index where the search begins</param>
+		/// <returns>The index of the char, or -1 if there is none</returns>
+		ptrdiff_t find_first_of(const char_set& chars, size_t from = 0) const;
+
+		/// <summary>
+		/// Finds the first char not in the set.
+		/// </summary>
+		/// <param name="chars">The set of chars to skip</param>
+		/// <param name="from">The index where the search begins</param>
+		/// <returns>The index of the char, or -1 if there is none</returns>
+		ptrdiff_t find_first_not_of(const char_set& chars, size_t from = 0) const;
+
+		/// <summary>
+		/// Counts the leading chars in the set.
+		/// </summary>
+		size_t span(const char_set& chars) const;
+
+		/// <summary>
+		/// Slices off the leading and trailing chars in the set.
+		/// </summary>
+		string_view trim(const char_set& chars) const;
+
+		string_view trim_start(const char_set& chars) const;
 
-		bool starts_with(const string_view& pattern) const;
+		string_view trim_end(const char_set& chars) const;
 
-		bool ends_with(const string_view& pattern) const;
+		/// <summary>
+		/// Slices off the leading and trailing ASCII whitespace.
+		/// </summary>
+		string_view trim() const;
 
-		bool contains(const string_view& pattern) const;
+		string_view trim_start() const;
+
+		string_view trim_end() const;
 
 	protected:
 		const char* m_begin;
 		const char* m_end;
 
-		const char* find_last(char target, const char* before) const;
+		constexpr const char* find(char target, const char* from) const;
 
-		const char* find(char target, const char* from) const;
+		constexpr const char* find(const string_view& target, const char* from) const;
 
-		const char* find(const string_view& target, const char* from) const;
+		/// <summary>
+		/// Whether the chars equal, the sizes being known equal.
+		/// </summary>
+		constexpr bool same_chars(const string_view& another) const;
+
+		/// <summary>
+		/// Replaces at most max_count occurrences of from, the first one being at first.
+		/// </summary>
+		nativa::string replace_from(const char* first, const string_view& from, const string_view& to, size_t max_count) const;
 
 	private:
+		// the runtime kernels behind the constexpr operations
+
+		const char* find_runtime(char target, const char* from) const;
+
+		const char* find_runtime(const string_view& target, const char* from) const;
+
+		int compare_runtime(const string_view& another) const;
+
 		template <typename OutputIt, typename Elem>
 		static auto cloned(OutputIt it)
 		{
@@ -175,6 +286,109 @@ namespace nativa
 		}
 	};
 
+	/// <summary>
+	/// How a splitter looks for its delimiter.
+	/// Specializations provide find(begin, end), returning end if not found, and size().
+	/// </summary>
+	template <typename Delimiter>
+	struct split_delimiter;
+
+	template <>
+	struct split_delimiter<char>
+	{
+		static const char* find(char delim, const char* begin, const char* end)
+		{
+			auto res = string_view(begin, end).index_of(delim);
+			return res == -1 ? end : begin + res;
+		}
+
+		static size_t size(char)
+		{
+			return 1;
+		}
+	};
+
+	template <>
+	struct split_delimiter<string_view>
+	{
+		static const char* find(const string_view& delim, const char* begin, const char* end)
+		{
+			auto res = string_view(begin, end).index_of(delim);
+			return res == -1 ? end : begin + res;
+		}
+
+		static size_t size(const string_view& delim)
+		{
+			return delim.size();
+		}
+	};
+
+	/// <summary>
+	/// The lazy range returned by string_view::split_range.
+	/// Its iterators refer to it, so keep it alive while iterating.
+	/// </summary>
+	template <typename Delimiter>
+	class splitter
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = nativa::string_view;
+			using difference_type = ptrdiff_t;
+			using pointer = const nativa::string_view*;
+			using reference = const nativa::string_view&;
+
+			iterator();
+
+			reference operator*() const;
+
+			pointer operator->() const;
+
+			iterator& operator++();
+
+			iterator operator++(int);
+
+			bool operator==(const iterator& another) const;
+
+			bool operator!=(const iterator& another) const;
+
+		private:
+			friend class splitter;
+
+			const splitter* m_owner;
+
+			nativa::string_view m_piece;
+
+			/// <summary>
+			/// Where the next slice begins, nullptr if the current one is the last
+			/// </summary>
+			const char* m_next;
+
+			size_t m_splits;
+
+			iterator(const splitter* owner, const char* next);
+
+			void advance();
+		};
+
+		splitter(const string_view& source, const Delimiter& delim, size_t max_splits, bool skip_empty);
+
+		iterator begin() const;
+
+		iterator end() const;
+
+	private:
+		nativa::string_view m_source;
+
+		Delimiter m_delim;
+
+		size_t m_max_splits;
+
+		bool m_skip_empty;
+	};
+
 	constexpr const char* c_str_end(const char* c_str)
 	{
 		auto it = c_str;
@@ -189,10 +403,195 @@ namespace nativa
 	}
 
 	inline constexpr string_view::string_view()
-		: m_begin(""), m_end("" + 1)
+		: string_view("")
+	{
+	}
+
+	inline constexpr string_view::string_view(const char* begin, const char* end) noexcept
+		: m_begin(begin), m_end(end)
 	{
 	}
 
+	inline constexpr const char* string_view::begin() const
+	{
+		return m_begin;
+	}
+
+	inline constexpr const char* string_view::end() const
+	{
+		return m_end;
+	}
+
+	inline constexpr size_t string_view::size() const
+	{
+		return m_end - m_begin;
+	}
+
+	inline constexpr bool string_view::is_empty() const
+	{
+		return size() == 0;
+	}
+
+	inline constexpr nativa::string_view string_view::slice(size_t begin, size_t length) const
+	{
+		assert(m_begin + begin + length <= m_end);
+		return nativa::string_view(m_begin + begin, m_begin + begin + length);
+	}
+
+	inline constexpr nativa::string_view string_view::operator[](const std::pair<size_t, size_t>& range) const
+	{
+		if (range.first == range.second) return "";
+		assert(range.first < this->size());
+		assert(range.second <= this->size());
+		return string_view(m_begin + range.first, m_begin + range.second);
+	}
+
+	inline constexpr int string_view::compare_to(const string_view& another) const
+	{
+		if (!std::is_constant_evaluated()) return compare_runtime(another);
+
+		auto lp = this->m_begin;
+		auto rp = another.m_begin;
+		for (;;)
+		{
+			if (lp == this->m_end)
+			{
+				if (rp == another.m_end)
+				{
+					return 0;
+				}
+
+				return -1;
+			}
+
+			if (rp == another.m_end)
+			{
+				return 1;
+			}
+
+			const char l = *lp;
+			const char r = *rp;
+			if (l < r) return -1;
+			else if (l > r) return 1;
+
+			++lp;
+			++rp;
+		}
+	}
+
+	inline constexpr bool string_view::same_chars(const string_view& another) const
+	{
+		if (!std::is_constant_evaluated())
+		{
+			return size() == 0 || std::memcmp(m_begin, another.m_begin, size()) == 0;
+		}
+
+		for (size_t i = 0; i < size(); ++i)
+		{
+			if (m_begin[i] != another.m_begin[i]) return false;
+		}
+		return true;
+	}
+
+	inline constexpr bool string_view::operator<(const string_view& right) const
+	{
+		return this->compare_to(right) < 0;
+	}
+
+	inline constexpr bool string_view::operator<=(const string_view& right) const
+	{
+		return this->compare_to(right) <= 0;
+	}
+
+	inline constexpr bool string_view::operator==(const string_view& right) const
+	{
+		return size() == right.size() && same_chars(right);
+	}
+
+	inline constexpr bool string_view::operator>=(const string_view& right) const
+	{
+		return this->compare_to(right) >= 0;
+	}
+
+	inline constexpr bool string_view::operator>(const string_view& right) const
+	{
+		return this->compare_to(right) > 0;
+	}
+
+	inline constexpr const char* string_view::find(char target, const char* since) const
+	{
+		assert(since != nullptr);
+		if (!std::is_constant_evaluated()) return find_runtime(target, since);
+
+		while (since != m_end && *since != target) ++since;
+		return since;
+	}
+
+	inline constexpr const char* string_view::find(const string_view& target, const char* since) const
+	{
+		assert(since != nullptr);
+		if (!std::is_constant_evaluated()) return find_runtime(target, since);
+
+		const size_t t_size = target.size();
+		if (static_cast<size_t>(m_end - since) < t_size) return t_size == 0 ? since : m_end;
+		for (const char* it = since; it + t_size <= m_end; ++it)
+		{
+			if (string_view(it, it + t_size).same_chars(target)) return it;
+		}
+		return m_end;
+	}
+
+	inline constexpr ptrdiff_t string_view::last_index_of(char target) const
+	{
+		if (is_empty()) return -1;
+		return last_index_of(target, size() - 1);
+	}
+
+	inline constexpr ptrdiff_t string_view::last_index_of(char target, size_t before) const
+	{
+		assert(before < size());
+
+		for (ptrdiff_t i = static_cast<ptrdiff_t>(before); i >= 0; --i)
+		{
+			if (m_begin[i] == target) return i;
+		}
+		return -1;
+	}
+
+	inline constexpr ptrdiff_t string_view::index_of(const char target, size_t since) const
+	{
+		auto res = find(target, m_begin + since);
+		if (res == m_end) return -1;
+		return res - m_begin;
+	}
+
+	inline constexpr ptrdiff_t string_view::index_of(const string_view& target, size_t since) const
+	{
+		auto res = find(target, m_begin + since);
+		if (res == m_end) return -1;
+		return res - m_begin;
+	}
+
+	inline constexpr bool string_view::starts_with(const string_view& pattern) const
+	{
+		size_t p_size = pattern.size();
+		if (p_size > this->size()) return false;
+		return this->slice(0, p_size).same_chars(pattern);
+	}
+
+	inline constexpr bool string_view::ends_with(const string_view& pattern) const
+	{
+		size_t m_size = this->size();
+		size_t p_size = pattern.size();
+		if (p_size > m_size) return false;
+		return this->slice(m_size - p_size, p_size).same_chars(pattern);
+	}
+
+	inline constexpr bool string_view::contains(const string_view& pattern) const
+	{
+		return find(pattern, m_begin) != m_end;
+	}
+
 	template <typename InsertIt>
 	inline void string_view::split(const string_view& delim, InsertIt output) const
 	{
@@ -224,6 +623,120 @@ namespace nativa
 		}
 	}
 
+	inline splitter<char> string_view::split_range(char delim, size_t max_splits, bool skip_empty) const
+	{
+		return splitter<char>(*this, delim, max_splits, skip_empty);
+	}
+
+	inline splitter<string_view> string_view::split_range(const string_view& delim, size_t max_splits, bool skip_empty) const
+	{
+		return splitter<string_view>(*this, delim, max_splits, skip_empty);
+	}
+
+	template <typename Delimiter>
+	inline splitter<Delimiter>::splitter(const string_view& source, const Delimiter& delim, size_t max_splits, bool skip_empty)
+		: m_source(source), m_delim(delim), m_max_splits(max_splits), m_skip_empty(skip_empty)
+	{
+		assert(split_delimiter<Delimiter>::size(delim) != 0);
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator splitter<Delimiter>::begin() const
+	{
+		return iterator(this, m_source.begin());
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator splitter<Delimiter>::end() const
+	{
+		return iterator();
+	}
+
+	template <typename Delimiter>
+	inline splitter<Delimiter>::iterator::iterator()
+		: m_owner(nullptr), m_next(nullptr), m_splits(0)
+	{
+	}
+
+	template <typename Delimiter>
+	inline splitter<Delimiter>::iterator::iterator(const splitter* owner, const char* next)
+		: m_owner(owner), m_next(next), m_splits(0)
+	{
+		advance();
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator::reference splitter<Delimiter>::iterator::operator*() const
+	{
+		return m_piece;
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator::pointer splitter<Delimiter>::iterator::operator->() const
+	{
+		return &m_piece;
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator& splitter<Delimiter>::iterator::operator++()
+	{
+		advance();
+		return *this;
+	}
+
+	template <typename Delimiter>
+	inline typename splitter<Delimiter>::iterator splitter<Delimiter>::iterator::operator++(int)
+	{
+		iterator temp = *this;
+		advance();
+		return temp;
+	}
+
+	template <typename Delimiter>
+	inline bool splitter<Delimiter>::iterator::operator==(const iterator& another) const
+	{
+		// the end iterator has no owner
+		if (m_owner == nullptr || another.m_owner == nullptr) return m_owner == another.m_owner;
+		return m_piece.begin() == another.m_piece.begin() && m_next == another.m_next;
+	}
+
+	template <typename Delimiter>
+	inline bool splitter<Delimiter>::iterator::operator!=(const iterator& another) const
+	{
+		return !this->operator==(another);
+	}
+
+	template <typename Delimiter>
+	inline void splitter<Delimiter>::iterator::advance()
+	{
+		using delimiter = split_delimiter<Delimiter>;
+
+		const char* end = m_owner->m_source.end();
+		for (;;)
+		{
+			if (m_next == nullptr) // the last slice has been handed out
+			{
+				m_owner = nullptr;
+				return;
+			}
+
+			const char* begin = m_next;
+			const char* found = (m_splits < m_owner->m_max_splits)
+				? delimiter::find(m_owner->m_delim, begin, end)
+				: end;
+
+			m_piece = nativa::string_view(begin, found);
+			m_next = (found == end)
+				? nullptr
+				: found + delimiter::size(m_owner->m_delim);
+
+			if (m_owner->m_skip_empty && m_piece.is_empty()) continue;
+
+			if (found != end) ++m_splits;
+			return;
+		}
+	}
+
 	template <typename Encoding>
 	inline auto string_view::access_as() const
 	{
@@ -251,24 +764,63 @@ namespace nativa
 	}
 }
 
+namespace nativa
+{
+	/// <summary>
+	/// Hashes the chars as a polynomial of 31, folding at compile time over constants.
+	/// The values are the same at compile time and at runtime,
+	/// where eight chars are taken a step to shorten the chain of multiplications.
+	/// </summary>
+	constexpr size_t hash(const string_view& sv)
+	{
+		size_t res = 0;
+		const char* it = sv.begin();
+		const char* const end = sv.end();
+		if (!std::is_constant_evaluated())
+		{
+			constexpr size_t p1 = 31, p2 = p1 * 31, p3 = p2 * 31, p4 = p3 * 31;
+			constexpr size_t p5 = p4 * 31, p6 = p5 * 31, p7 = p6 * 31, p8 = p7 * 31;
+			for (; end - it >= 8; it += 8)
+			{
+				res = res * p8
+					+ static_cast<size_t>(it[0]) * p7 + static_cast<size_t>(it[1]) * p6
+					+ static_cast<size_t>(it[2]) * p5 + static_cast<size_t>(it[3]) * p4
+					+ static_cast<size_t>(it[4]) * p3 + static_cast<size_t>(it[5]) * p2
+					+ static_cast<size_t>(it[6]) * p1 + static_cast<size_t>(it[7]);
+			}
+		}
+		for (; it != end; ++it)
+		{
+			res = res * 31 + static_cast<size_t>(*it);
+		}
+		return res;
+	}
+
+	/// <summary>
+	/// Same as hash, but always computed at compile time,
+	/// for case labels and static tables: switch (hash(sv)) { case static_hash("GET"): ... }
+	/// </summary>
+	consteval size_t static_hash(const string_view& sv)
+	{
+		return hash(sv);
+	}
+}
+
 namespace std
 {
 	template <>
 	struct hash<nativa::string_view>
 	{
-		size_t operator()(const nativa::string_view& sv) const
+		constexpr size_t operator()(const nativa::string_view& sv) const
 		{
-			size_t hash = 0;
-			for (char c : sv)
-			{
-				hash *= 31;
-				hash += c;
-			}
-			return hash;
+			return nativa::hash(sv);
 		}
 	};
 }
 
-nativa::string_view operator""_ns(const char* c_str, size_t len);
+constexpr nativa::string_view operator""_ns(const char* c_str, size_t len)
+{
+	return nativa::string_view(c_str, c_str + len);
+}
 
 #endif
\ No newline at end of file
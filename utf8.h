@@ -236,9 +236,9 @@ namespace nativa
 				*out = static_cast<uint8_t>(0b10000000 | (static_cast<uint32_t>(c) & 0b111111));
 				++out;
 			}
-			else if (c <= U'\x1FFFF')
+			else if (c <= U'\x10FFFF')
 			{
-				*out = static_cast<uint8_t>(0b11100000 | (static_cast<uint32_t>(c) >> 18));
+				*out = static_cast<uint8_t>(0b11110000 | (static_cast<uint32_t>(c) >> 18));
 				++out;
 				*out = static_cast<uint8_t>(0b10000000 | ((static_cast<uint32_t>(c) >> 12) & 0b111111));
 				++out;